@@ -0,0 +1,61 @@
+#include <cstdlib>
+#include <new>
+#include "Benchmark.hpp"
+
+
+using namespace Lottery;
+
+
+std::atomic<uint64_t> AllocationCounters::count{ 0 };
+std::atomic<uint64_t> AllocationCounters::bytes{ 0 };
+
+
+//count the allocations of the whole program; the replaced functions are kept in their own
+//translation unit, so that they are not inlined into code that pairs the new with std::free
+void *operator new(size_t size)
+{
+    ++AllocationCounters::count;
+    AllocationCounters::bytes += size;
+    if (void *ptr = std::malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    ++AllocationCounters::count;
+    AllocationCounters::bytes += size;
+    const size_t align = (size_t)alignment;
+    if (void *ptr = std::aligned_alloc(align, (size + align - 1) / align * align))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,129 @@
+#ifndef LOTTERY_BENCHMARK_HPP
+#define LOTTERY_BENCHMARK_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Global allocation counters; updated by the replaced operator new of the benchmark program.
+     */
+    struct AllocationCounters
+    {
+        ///number of allocations.
+        static std::atomic<uint64_t> count;
+
+        ///number of bytes allocated.
+        static std::atomic<uint64_t> bytes;
+    };
+
+
+    /**
+        Result of a benchmark.
+     */
+    struct BenchmarkResult
+    {
+        ///name of the benchmark.
+        std::string name;
+
+        ///number of operations executed.
+        uint64_t iterations = 0;
+
+        ///number of items processed.
+        uint64_t items = 0;
+
+        ///nanoseconds per operation.
+        double nsPerOp = 0;
+
+        ///items processed per second.
+        double itemsPerSec = 0;
+
+        ///allocations per operation.
+        double allocsPerOp = 0;
+
+        ///bytes allocated per operation.
+        double bytesPerOp = 0;
+    };
+
+
+    /**
+        Function under benchmark.
+        It executes the given number of operations and returns the number of items processed.
+     */
+    typedef std::function<uint64_t(uint64_t iterations)> BenchmarkFunction;
+
+
+    /**
+        Runs a function, doubling the number of operations until it runs for at least the given time.
+        @param name name of the benchmark.
+        @param func function to run.
+        @param minTime minimum time to measure.
+        @return the result of the longest run.
+     */
+    inline BenchmarkResult runBenchmark(const std::string &name, const BenchmarkFunction &func, std::chrono::nanoseconds minTime)
+    {
+        BenchmarkResult result;
+        result.name = name;
+
+        for (uint64_t iterations = 1;; iterations *= 2)
+        {
+            const uint64_t allocCount = AllocationCounters::count.load();
+            const uint64_t allocBytes = AllocationCounters::bytes.load();
+            const auto startTime = std::chrono::steady_clock::now();
+
+            const uint64_t items = func(iterations);
+
+            const auto duration = std::chrono::steady_clock::now() - startTime;
+            const double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+
+            result.iterations = iterations;
+            result.items = items;
+            result.nsPerOp = ns / iterations;
+            result.itemsPerSec = ns > 0 ? items * 1e9 / ns : 0;
+            result.allocsPerOp = (double)(AllocationCounters::count.load() - allocCount) / iterations;
+            result.bytesPerOp = (double)(AllocationCounters::bytes.load() - allocBytes) / iterations;
+
+            if (duration >= minTime || iterations >= (1ull << 40))
+            {
+                return result;
+            }
+        }
+    }
+
+
+    /**
+        Writes results as JSON.
+     */
+    template <class Stream> void writeBenchmarkJson(Stream &stream, const std::vector<BenchmarkResult> &results)
+    {
+        stream << "{\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const BenchmarkResult &result = results[i];
+            stream << (i ? ",\n" : "\n");
+            stream << "    {";
+            stream << "\"name\": \"" << result.name << "\", ";
+            stream << "\"iterations\": " << result.iterations << ", ";
+            stream << "\"items\": " << result.items << ", ";
+            stream << "\"ns_per_op\": " << result.nsPerOp << ", ";
+            stream << "\"items_per_sec\": " << result.itemsPerSec << ", ";
+            stream << "\"allocs_per_op\": " << result.allocsPerOp << ", ";
+            stream << "\"bytes_per_op\": " << result.bytesPerOp;
+            stream << "}";
+        }
+        stream << "\n  ]\n}\n";
+    }
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_BENCHMARK_HPP
@@ -0,0 +1,526 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <filesystem>
+#include <random>
+#include <algorithm>
+#include "Benchmark.hpp"
+#include "CSVFile.hpp"
+#include "Game.hpp"
+#include "Backtest.hpp"
+#include "createRows.hpp"
+#include "createPermutations.hpp"
+#include "calcAllColumnsCount.hpp"
+#include "PredictionAlgorithmFactory.hpp"
+#include "SlidingDrawWindow.hpp"
+#include "ColumnStatistics.hpp"
+#include "SnapshotManager.hpp"
+#include "TicketScorer.hpp"
+
+
+using namespace std;
+using namespace Lottery;
+
+
+//prevents the compiler from optimizing away a value
+template <class T> static void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+
+//writes a synthetic game with two subgames and the given number of draws
+static void writeSyntheticGame(const std::filesystem::path &directory, size_t drawsCount)
+{
+    std::filesystem::create_directories(directory);
+
+    CSVFile gameFile;
+    gameFile.openForWriting((directory / "Game.csv").string(), 4);
+    gameFile.write("SubGame");
+    gameFile.write("MinNumber");
+    gameFile.write("MaxNumber");
+    gameFile.write("NumberCount");
+    gameFile.write("Main");
+    gameFile.write((size_t)1);
+    gameFile.write((size_t)49);
+    gameFile.write((size_t)6);
+    gameFile.write("Bonus");
+    gameFile.write((size_t)1);
+    gameFile.write((size_t)20);
+    gameFile.write((size_t)1);
+    gameFile.close();
+
+    CSVFile drawsFile;
+    drawsFile.openForWriting((directory / "Draws.csv").string(), 7);
+    for (size_t i = 1; i <= 6; ++i)
+    {
+        drawsFile.write("Number_" + std::to_string(i));
+    }
+    drawsFile.write("Bonus");
+
+    std::mt19937_64 engine(drawsCount);
+    std::vector<int> pool(49);
+    for (size_t draw = 0; draw < drawsCount; ++draw)
+    {
+        for (int i = 0; i < 49; ++i)
+        {
+            pool[i] = i + 1;
+        }
+        std::shuffle(pool.begin(), pool.end(), engine);
+        std::sort(pool.begin(), pool.begin() + 6);
+        for (int i = 0; i < 6; ++i)
+        {
+            drawsFile.write(pool[i]);
+        }
+        drawsFile.write((int)std::uniform_int_distribution<int>(1, 20)(engine));
+    }
+    drawsFile.close();
+}
+
+
+//checks that a steady-state backtest does not allocate: once the arena and the predictions
+//have grown in the first draws, predicting and scoring the next draws must not touch the heap
+static bool checkSteadyStateAllocations(const Game &game)
+{
+    static constexpr size_t WarmUpDrawCount = 64;
+    static constexpr size_t CheckedDrawCount = 1024;
+
+    if (game.getDrawsCount() <= WarmUpDrawCount + CheckedDrawCount + 1)
+    {
+        cout << "Backtest::run/Random/steady: too few draws (FAILED)" << endl;
+        return false;
+    }
+
+    std::vector<std::unique_ptr<PredictionAlgorithm>> predictionAlgorithms;
+    predictionAlgorithms.push_back(createPredictionAlgorithm("Random(seed=1)", game));
+    Backtest backtest(game, predictionAlgorithms, game.getDrawsCount() - WarmUpDrawCount - CheckedDrawCount - 1);
+    backtest.initialize();
+    backtest.run(WarmUpDrawCount);
+
+    const uint64_t allocCount = AllocationCounters::count.load();
+    backtest.run(CheckedDrawCount);
+    const uint64_t allocations = AllocationCounters::count.load() - allocCount;
+
+    cout << "Backtest::run/Random/steady: " << allocations << " allocations in " << CheckedDrawCount << " draws"
+         << (allocations ? " (FAILED)" : "") << endl;
+    return allocations == 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::string jsonFile;
+    std::string filter;
+    double minTimeSecs = 0.5;
+    size_t largeDrawsCount = 100000;
+    bool check = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--json" && i + 1 < argc)
+        {
+            jsonFile = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc)
+        {
+            minTimeSecs = std::stod(argv[++i]);
+        }
+        else if (arg == "--large-draws" && i + 1 < argc)
+        {
+            largeDrawsCount = std::stoul(argv[++i]);
+        }
+        else if (arg == "--check")
+        {
+            check = true;
+        }
+        else
+        {
+            cout << "Usage: Benchmark [--json <file>] [--filter <text>] [--min-time <secs>] [--large-draws <count>]\n";
+            cout << "       Benchmark --check [--large-draws <count>]\n";
+            return -1;
+        }
+    }
+
+    const auto minTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(minTimeSecs));
+
+    //prepare the data
+    const std::filesystem::path dataDir = std::filesystem::temp_directory_path() / "LotteryBenchmark";
+    const std::filesystem::path smallDir = dataDir / "Small";
+    const std::filesystem::path largeDir = dataDir / "Large";
+    const size_t SmallDrawsCount = 2000;
+    writeSyntheticGame(smallDir, SmallDrawsCount);
+    writeSyntheticGame(largeDir, largeDrawsCount);
+
+    Game smallGame;
+    smallGame.load((smallDir / "Game.csv").string(), (smallDir / "Draws.csv").string());
+
+    Game largeGame;
+    largeGame.load((largeDir / "Game.csv").string(), (largeDir / "Draws.csv").string());
+
+    //check the properties that must not regress; the exit code is nonzero if a check fails
+    if (check)
+    {
+        const bool passed = checkSteadyStateAllocations(largeGame);
+        std::error_code error;
+        std::filesystem::remove_all(dataDir, error);
+        return passed ? 0 : 1;
+    }
+
+    std::vector<std::pair<std::string, BenchmarkFunction>> benchmarks;
+
+    //csv
+    benchmarks.emplace_back("CSVFile/write", [&](uint64_t iterations)
+    {
+        const std::string filename = (dataDir / "Write.csv").string();
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            CSVFile file;
+            file.openForWriting(filename, 7);
+            for (size_t draw = 0; draw < SmallDrawsCount; ++draw)
+            {
+                for (size_t column = 0; column < 7; ++column)
+                {
+                    file.write(draw % 49 + column);
+                }
+            }
+            items += SmallDrawsCount * 7;
+        }
+        return items;
+    });
+
+    benchmarks.emplace_back("CSVFile/read", [&](uint64_t iterations)
+    {
+        const std::string filename = (smallDir / "Draws.csv").string();
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            CSVFile file;
+            file.openForReading(filename.c_str());
+            std::string str;
+            for (size_t column = 0; column < 7; ++column)
+            {
+                file.read(str);
+            }
+            for (size_t num = 1; num;)
+            {
+                num = 0;
+                file.read(num);
+                items += num ? 1 : 0;
+            }
+        }
+        return items;
+    });
+
+    //game loading
+    benchmarks.emplace_back("Game::load/small", [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            Game game;
+            game.load((smallDir / "Game.csv").string(), (smallDir / "Draws.csv").string());
+            doNotOptimize(game);
+        }
+        return iterations * SmallDrawsCount;
+    });
+
+    benchmarks.emplace_back("Game::load/large", [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            Game game;
+            game.load((largeDir / "Game.csv").string(), (largeDir / "Draws.csv").string());
+            doNotOptimize(game);
+        }
+        return iterations * largeDrawsCount;
+    });
+
+    //ticket scoring
+    benchmarks.emplace_back("TicketScorer::score/large/64", [&](uint64_t iterations)
+    {
+        const TicketScorer scorer(largeGame.getSubGames()[0]);
+        std::mt19937 random(1);
+        std::vector<NumberMask> tickets;
+        for (size_t i = 0; i < 64; ++i)
+        {
+            std::vector<Number> numbers;
+            for (size_t j = 0; j < 5; ++j)
+            {
+                numbers.push_back((Number)(random() % 45 + 1));
+            }
+            tickets.push_back(TicketScorer::createMask(numbers.begin(), numbers.end()));
+        }
+        std::vector<uint32_t> results(tickets.size() * scorer.getResultSize());
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            scorer.score(tickets.data(), tickets.size(), results.data());
+            doNotOptimize(results);
+        }
+        return iterations * tickets.size() * scorer.getDrawsCount();
+    });
+
+    //snapshots
+    SnapshotManager<Game> snapshots(std::make_unique<Game>(smallGame));
+    benchmarks.emplace_back("SnapshotManager::pin", [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            const SnapshotManager<Game>::Pin pin = snapshots.pin();
+            doNotOptimize(pin->getDrawsCount());
+        }
+        return iterations;
+    });
+
+    benchmarks.emplace_back("SnapshotManager::publish/small", [&](uint64_t iterations)
+    {
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            snapshots.publish(std::make_unique<Game>(*snapshots.pin()));
+        }
+        return iterations * SmallDrawsCount;
+    });
+
+    //enumeration
+    benchmarks.emplace_back("createRows/45x5", [&](uint64_t iterations)
+    {
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            createRows<Number>(1, 45, 5, [&](const auto &row)
+            {
+                ++items;
+                doNotOptimize(row);
+                return true;
+            });
+        }
+        return items;
+    });
+
+    benchmarks.emplace_back("createRows/45x5/parallel", [&](uint64_t iterations)
+    {
+        std::vector<Number> values;
+        for (Number number = 1; number <= 45; ++number)
+        {
+            values.push_back(number);
+        }
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            items += parallelReduce(TaskScheduler::getDefault(), 0, getRowCount(values.size(), 5), 1 << 16, uint64_t(0), [&](size_t beginRank, size_t endRank)
+            {
+                uint64_t rangeItems = 0;
+                createRows(values, 5, beginRank, endRank, [&](const auto &row)
+                {
+                    ++rangeItems;
+                    doNotOptimize(row);
+                    return true;
+                });
+                return rangeItems;
+            },
+            [](uint64_t a, uint64_t b) { return a + b; });
+        }
+        return items;
+    });
+
+    benchmarks.emplace_back("createPermutations/9", [&](uint64_t iterations)
+    {
+        const std::vector<Number> symbols{ 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            createPermutations(symbols, [&](const auto &permutation)
+            {
+                ++items;
+                doNotOptimize(permutation);
+                return true;
+            });
+        }
+        return items;
+    });
+
+    benchmarks.emplace_back("calcAllColumnsCount/49x6", [&](uint64_t iterations)
+    {
+        volatile size_t maxNumber = 49;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            const size_t count = calcAllColumnsCount(6, maxNumber);
+            doNotOptimize(count);
+        }
+        return iterations;
+    });
+
+    //window statistics over the whole history
+    benchmarks.emplace_back("SlidingDrawWindow::advance/100", [&](uint64_t iterations)
+    {
+        const SubGame &subGame = smallGame.getSubGames()[0];
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            SlidingDrawWindow window(subGame, 100);
+            while (window.advance())
+            {
+            }
+            doNotOptimize(window.getSum());
+        }
+        return iterations * SmallDrawsCount;
+    });
+
+    //column statistics
+    benchmarks.emplace_back("computeColumnMoments/large", [&](uint64_t iterations)
+    {
+        const NumberColumn &column = largeGame.getSubGames()[0].getDrawsByColumn()[0];
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            const ColumnMoments moments = computeColumnMoments(column.data(), column.size());
+            doNotOptimize(moments);
+        }
+        return iterations * column.size();
+    });
+
+    benchmarks.emplace_back("PositionalDistribution::advance/large", [&](uint64_t iterations)
+    {
+        const SubGame &subGame = largeGame.getSubGames()[0];
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            PositionalDistribution distribution(subGame);
+            double variance = 0;
+            while (distribution.advance())
+            {
+                variance += distribution.getMoments(0).getVariance();
+            }
+            doNotOptimize(variance);
+        }
+        return iterations * largeDrawsCount;
+    });
+
+    //prediction
+    for (const std::string &name : getPredictionAlgorithmNames())
+    {
+        benchmarks.emplace_back("PredictionAlgorithm::predict/" + name, [&, name](uint64_t iterations)
+        {
+            const SubGame &subGame = smallGame.getSubGames()[0];
+            const size_t sampleSize = 2 * SmallDrawsCount / 3;
+            auto algo = createPredictionAlgorithm(name, smallGame);
+            algo->initialize(subGame, DrawVectorRange(subGame.getDraws().begin(), subGame.getDraws().begin() + sampleSize));
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                const size_t drawIndex = sampleSize + i % (SmallDrawsCount - sampleSize);
+                Prediction prediction;
+                prediction.count = subGame.getNumberCount() * 2;
+                algo->predict(subGame, DrawVectorRange(subGame.getDraws().begin(), subGame.getDraws().begin() + drawIndex), prediction);
+                doNotOptimize(prediction);
+            }
+            algo->finalize(subGame, subGame.getDraws());
+            return iterations;
+        });
+
+        //the same draws predicted in batches, into a per-batch arena, as the backtest does;
+        //an operation is a whole batch of 16 draws, and the items are the draws predicted
+        benchmarks.emplace_back("PredictionAlgorithm::predictBatch/16/" + name, [&, name](uint64_t iterations)
+        {
+            const SubGame &subGame = smallGame.getSubGames()[0];
+            const size_t sampleSize = 2 * SmallDrawsCount / 3;
+            const size_t batchSize = 16;
+            const size_t batchCount = (SmallDrawsCount - sampleSize) / batchSize;
+            auto algo = createPredictionAlgorithm(name, smallGame);
+            algo->initialize(subGame, DrawVectorRange(subGame.getDraws().begin(), subGame.getDraws().begin() + sampleSize));
+            StepArena arena;
+            std::vector<Prediction> predictions;
+            predictions.reserve(batchSize);
+            uint64_t items = 0;
+            for (uint64_t i = 0; i < iterations; ++i)
+            {
+                const size_t beginDrawIndex = sampleSize + i % batchCount * batchSize;
+                predictions.clear();
+                arena.reset();
+                for (size_t j = 0; j < batchSize; ++j)
+                {
+                    predictions.emplace_back(&arena);
+                    predictions.back().count = subGame.getNumberCount() * 2;
+                }
+                algo->predictBatch(subGame, beginDrawIndex, beginDrawIndex + batchSize, predictions.data());
+                doNotOptimize(predictions);
+                items += batchSize;
+            }
+            algo->finalize(subGame, subGame.getDraws());
+            return items;
+        });
+    }
+
+    //the scoring loop, one draw per iteration, after the per-draw arena has grown;
+    //a steady-state backtest does not allocate, except when the backtest is recreated after its last draw
+    std::vector<std::unique_ptr<PredictionAlgorithm>> steadyAlgorithms;
+    steadyAlgorithms.push_back(createPredictionAlgorithm("Random(seed=1)", largeGame));
+    std::unique_ptr<Backtest> steadyBacktest;
+    benchmarks.emplace_back("Backtest::run/Random/steady", [&](uint64_t iterations)
+    {
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            if (!steadyBacktest || steadyBacktest->isComplete())
+            {
+                steadyBacktest = std::make_unique<Backtest>(largeGame, steadyAlgorithms, 2 * largeGame.getDrawsCount() / 3);
+                steadyBacktest->initialize();
+                steadyBacktest->run(1);
+            }
+            steadyBacktest->run(1);
+            items += largeGame.getSubGames().size();
+        }
+        return items;
+    });
+
+    //the scoring loop
+    benchmarks.emplace_back("Backtest::run/Random", [&](uint64_t iterations)
+    {
+        std::vector<std::unique_ptr<PredictionAlgorithm>> predictionAlgorithms;
+        predictionAlgorithms.push_back(createPredictionAlgorithm("Random(seed=1)", smallGame));
+        uint64_t items = 0;
+        for (uint64_t i = 0; i < iterations; ++i)
+        {
+            Backtest backtest(smallGame, predictionAlgorithms, 2 * SmallDrawsCount / 3);
+            backtest.initialize();
+            const size_t beginDrawIndex = backtest.getTestDrawIndex();
+            backtest.run();
+            backtest.finalize();
+            items += (backtest.getTestDrawIndex() - beginDrawIndex) * smallGame.getSubGames().size();
+        }
+        return items;
+    });
+
+    //run the benchmarks
+    std::vector<BenchmarkResult> results;
+    cout << std::left << std::setw(40) << "Benchmark" << std::right
+         << std::setw(14) << "ns/op" << std::setw(16) << "items/sec" << std::setw(12) << "allocs/op" << std::setw(14) << "bytes/op" << '\n';
+    for (const auto &benchmark : benchmarks)
+    {
+        if (benchmark.first.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        const BenchmarkResult result = runBenchmark(benchmark.first, benchmark.second, minTime);
+        cout << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(1)
+             << std::setw(14) << result.nsPerOp << std::setw(16) << result.itemsPerSec
+             << std::setw(12) << result.allocsPerOp << std::setw(14) << result.bytesPerOp << endl;
+        results.push_back(result);
+    }
+
+    //write the results for tracking regressions
+    if (!jsonFile.empty())
+    {
+        std::ofstream file(jsonFile);
+        if (!file.is_open())
+        {
+            cout << "Error: the file " << jsonFile << " could not be opened for writing\n";
+            return -1;
+        }
+        writeBenchmarkJson(file, results);
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(dataDir, error);
+
+    return 0;
+}
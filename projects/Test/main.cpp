@@ -1,21 +1,213 @@
 #include <iostream>
 #include <memory>
-#include <unordered_map>
 #include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <filesystem>
 #include "CSVFile.hpp"
+#include "Backtest.hpp"
 #include "Game.hpp"
-#include "RandomPredictionAlgorithm.hpp"
-#include "PredictionAlgorithmA.hpp"
-#include "profile.hpp"
+#include "Batch.hpp"
+#include "Experiment.hpp"
+#include "Follower.hpp"
+#include "Distributed.hpp"
+#include "PredictionServer.hpp"
+#include "PredictionAlgorithmFactory.hpp"
+#include "Profile.hpp"
+#include "MemoryTracker.hpp"
+#include "parseNumber.hpp"
 
 
 using namespace std;
 using namespace Lottery;
 
 
-int main()
+//number of draws in the pipeline, when pipelined
+static constexpr size_t PipelineCapacity = 64;
+
+
+//set on interrupt, to stop following the draws or serving
+static std::atomic<bool> stopRunning(false);
+
+
+//prints the predictions of the next draw
+static void printPredictions(const Follower &follower, const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms)
+{
+    const SnapshotManager<Game>::Pin pin = follower.pinGame();
+    const Game &game = *pin;
+    cout << "Next draw " << game.getFirstDrawIndex() + game.getDrawsCount() << " (" << follower.getUpdateDuration() / 1000 << "us):\n";
+    for (size_t algoIndex = 0; algoIndex < predictionAlgorithms.size(); ++algoIndex)
+    {
+        for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
+        {
+            const Prediction &prediction = follower.getPredictions()[algoIndex * game.getSubGames().size() + subGameIndex];
+            std::vector<Number> numbers(prediction.numbers.begin(), prediction.numbers.end());
+            std::sort(numbers.begin(), numbers.end());
+            cout << "    " << predictionAlgorithms[algoIndex]->getName() << ' ' << game.getSubGames()[subGameIndex].getName() << ':';
+            for (const Number number : numbers)
+            {
+                cout << ' ' << (size_t)number;
+            }
+            cout << '\n';
+        }
+    }
+    cout.flush();
+}
+
+
+int main(int argc, char *argv[])
 {
     LOTTERY_PROFILE(Test);
+
+    //parse the arguments
+    bool resume = false;
+    size_t checkpointInterval = 10000;
+    std::string cacheDir;
+    bool hitTrace = false;
+    std::string batchRoot;
+    std::string experimentsFile;
+    std::vector<std::string> algorithms = getPredictionAlgorithmNames();
+    DrawLayout layout = DrawLayout::Both;
+    size_t tailDrawCount = 0;
+    size_t firstDrawIndex = 0;
+    bool follow = false;
+    bool pipeline = false;
+    std::string serveAddress;
+    std::string coordinateFile;
+    uint16_t port = 0;
+    size_t unitDrawCount = 1000;
+    std::string workAddress;
+    size_t threadCount = 0;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--resume")
+            {
+                resume = true;
+            }
+            else if (arg == "--checkpoint-interval" && i + 1 < argc)
+            {
+                checkpointInterval = std::max<size_t>(parseNumber(argv[++i], "checkpoint interval"), 1);
+            }
+            else if (arg == "--cache" && i + 1 < argc)
+            {
+                cacheDir = argv[++i];
+            }
+            else if (arg == "--hit-trace")
+            {
+                hitTrace = true;
+            }
+            else if (arg == "--batch" && i + 1 < argc)
+            {
+                batchRoot = argv[++i];
+            }
+            else if (arg == "--experiments" && i + 1 < argc)
+            {
+                experimentsFile = argv[++i];
+            }
+            else if (arg == "--layout" && i + 1 < argc && (argv[i + 1] == std::string("rows") || argv[i + 1] == std::string("columns") || argv[i + 1] == std::string("both")))
+            {
+                const std::string value = argv[++i];
+                layout = value == "rows" ? DrawLayout::Rows : value == "columns" ? DrawLayout::Columns : DrawLayout::Both;
+            }
+            else if (arg == "--tail" && i + 1 < argc)
+            {
+                tailDrawCount = std::max<size_t>(parseNumber(argv[++i], "tail draw count"), 1);
+            }
+            else if (arg == "--from" && i + 1 < argc)
+            {
+                firstDrawIndex = parseNumber(argv[++i], "first draw index");
+            }
+            else if (arg == "--pipeline")
+            {
+                pipeline = true;
+            }
+            else if (arg == "--follow")
+            {
+                follow = true;
+            }
+            else if (arg == "--serve" && i + 1 < argc)
+            {
+                serveAddress = argv[++i];
+            }
+            else if (arg == "--coordinate" && i + 1 < argc)
+            {
+                coordinateFile = argv[++i];
+            }
+            else if (arg == "--port" && i + 1 < argc)
+            {
+                port = (uint16_t)parseNumber(argv[++i], "port", UINT16_MAX);
+            }
+            else if (arg == "--unit-draws" && i + 1 < argc)
+            {
+                unitDrawCount = std::max<size_t>(parseNumber(argv[++i], "unit draw count"), 1);
+            }
+            else if (arg == "--work" && i + 1 < argc && std::string(argv[i + 1]).find(':') != std::string::npos)
+            {
+                workAddress = argv[++i];
+            }
+            else if (arg == "--threads" && i + 1 < argc)
+            {
+                threadCount = parseNumber(argv[++i], "thread count");
+            }
+            else if (arg == "--algorithms" && i + 1 < argc)
+            {
+                algorithms.clear();
+                std::stringstream stream(argv[++i]);
+                for (std::string name; std::getline(stream, name, ',');)
+                {
+                    algorithms.push_back(name);
+                }
+            }
+            else
+            {
+                cout << "Usage: Test [--resume] [--checkpoint-interval <draws>] [--cache <dir>] [--hit-trace] [--layout rows|columns|both] [--tail <draws> | --from <draw>]\n";
+                cout << "       Test --pipeline [--resume] [--checkpoint-interval <draws>] [--cache <dir>] [--hit-trace] [--layout rows|columns|both] [--tail <draws> | --from <draw>]\n";
+                cout << "       Test --batch <root> [--algorithms <name,...>] [--cache <dir>]\n";
+                cout << "       Test --experiments <file> [--cache <dir>]\n";
+                cout << "       Test --follow [--algorithms <name,...>] [--layout rows|columns|both] [--tail <draws> | --from <draw>]\n";
+                cout << "       Test --serve <socket path | port> [--algorithms <name,...>] [--tail <draws> | --from <draw>]\n";
+                cout << "       Test --coordinate <experiments file> [--port <port>] [--unit-draws <draws>]\n";
+                cout << "       Test --work <host>:<port> [--threads <count>]\n";
+                return -1;
+            }
+        }
+    }
+    catch (const std::runtime_error &error)
+    {
+        cout << "Error: " << error.what() << endl;
+        return -1;
+    }
+
+    //run units of a coordinator until it is done; the game directories are those of the coordinator
+    if (!workAddress.empty())
+    {
+        try
+        {
+            const size_t separator = workAddress.rfind(':');
+            const uint16_t workPort = (uint16_t)parseNumber(workAddress.substr(separator + 1), "port", UINT16_MAX);
+            if (threadCount > 0)
+            {
+                TaskScheduler scheduler(threadCount);
+                runWorker(workAddress.substr(0, separator), workPort, scheduler);
+            }
+            else
+            {
+                runWorker(workAddress.substr(0, separator), workPort);
+            }
+        }
+        catch (const std::exception &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        return 0;
+    }
+
     const char *outDir = getenv("LOTTERYPRIVATE");
     if (!outDir)
     {
@@ -23,13 +215,101 @@ int main()
         return -1;
     }
 
+    //serve the results from the cache, if requested
+    std::unique_ptr<ResultCache> resultCache;
+    if (!cacheDir.empty())
+    {
+        try
+        {
+            resultCache = std::make_unique<ResultCache>(cacheDir);
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+    }
+
+    //run the experiments of the given file in this process
+    if (!experimentsFile.empty())
+    {
+        try
+        {
+            LOTTERY_PROFILE(Experiments);
+            ExperimentRunner runner(TaskScheduler::getDefault(), resultCache.get());
+            runner.run(loadExperiments(experimentsFile));
+            if (MemoryTracker::isEnabled())
+            {
+                MemoryTracker::report();
+            }
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    //run the experiments of the given file on the workers that connect
+    if (!coordinateFile.empty())
+    {
+        try
+        {
+            LOTTERY_PROFILE(Coordinate);
+            const std::vector<Experiment> experiments = loadExperiments(coordinateFile);
+            Coordinator coordinator(experiments, unitDrawCount);
+            cout << "Listening for workers on port " << coordinator.listen(port) << " for " << coordinator.getUnits().size() << " units" << endl;
+            coordinator.run();
+            cout << "Done; " << coordinator.getReissuedCount() << " units issued again" << endl;
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        return 0;
+    }
+
+    //test all the games under the given directory
+    if (!batchRoot.empty())
+    {
+        try
+        {
+            LOTTERY_PROFILE(Batch);
+            const std::vector<BatchGameResult> results = runBatch(batchRoot, algorithms, TaskScheduler::getDefault(), resultCache.get());
+            writeBatchReport(std::string(outDir) + "/Data/Batch.csv", results);
+            if (MemoryTracker::isEnabled())
+            {
+                MemoryTracker::report();
+            }
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        return 0;
+    }
+
     Game game;
 
     //load the game
     try
     {
         LOTTERY_PROFILE(LoadGame);
-        game.load();
+        if (tailDrawCount > 0)
+        {
+            game.loadTail("Game.csv", "Draws.csv", tailDrawCount, layout);
+        }
+        else if (firstDrawIndex > 0)
+        {
+            game.loadFrom("Game.csv", "Draws.csv", firstDrawIndex, layout);
+        }
+        else
+        {
+            game.load("Game.csv", "Draws.csv", layout);
+        }
     }
     catch (const std::runtime_error &error)
     {
@@ -39,141 +319,177 @@ int main()
 
     //total draws loaded
     const size_t TotalDraws = game.getDrawsCount();
+    if (game.getFirstDrawIndex() > 0)
+    {
+        cout << "Loaded " << TotalDraws << " draws from draw " << game.getFirstDrawIndex() << endl;
+    }
 
-    //set up the algorithms to use for testing
+    //set up the algorithms to use for testing;
+    //by default, a random prediction to compare against and the rest of the algorithms
     std::vector<std::unique_ptr<PredictionAlgorithm>> predictionAlgorithms;
-
-    //add a random prediction to compare against
-    predictionAlgorithms.push_back(std::make_unique<RandomPredictionAlgorithm>(game));
-    predictionAlgorithms.push_back(std::make_unique<PredictionAlgorithmA>(game));
-
-    //sample size (currently at 2/3 of total data)
-    const size_t SampleSize = 2 * TotalDraws / 3;
-
-    //initialize each the algorithm for each subgame
+    try
     {
-        LOTTERY_PROFILE(InitializeAlgorithms);
-        for (size_t i = 0; i < game.getSubGames().size(); ++i)
+        for (const std::string &name : algorithms)
         {
-            const SubGame &subGame = game.getSubGames()[i];
+            predictionAlgorithms.push_back(createPredictionAlgorithm(name, game));
+        }
+    }
+    catch (const std::runtime_error &error)
+    {
+        cout << "Error: " << error.what() << endl;
+        return -1;
+    }
 
-            //prepare the sample draws
-            DrawVectorRange sampleDraws(subGame.getDraws().begin(), subGame.getDraws().begin() + SampleSize);
+    //follow the draws file, predicting the next draw whenever draws are appended, until interrupted
+    if (follow)
+    {
+        try
+        {
+            Follower follower(game, "Draws.csv", predictionAlgorithms);
+            follower.initialize();
+            printPredictions(follower, predictionAlgorithms);
+            cout << "Following Draws.csv" << (follower.isNotified() ? "" : " (polling)") << endl;
+            std::signal(SIGINT, [](int) { stopRunning = true; });
+            follower.run([&](const Follower &follower) { printPredictions(follower, predictionAlgorithms); }, stopRunning);
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        return 0;
+    }
 
-            //initialize the algorithms
-            for (const auto &algo : predictionAlgorithms)
+    //serve predictions and ticket scores on a Unix domain socket or a local TCP port, until interrupted
+    if (!serveAddress.empty())
+    {
+        try
+        {
+            PredictionServer server(game, predictionAlgorithms);
+            if (serveAddress.find_first_not_of("0123456789") == std::string::npos)
+            {
+                cout << "Serving on port " << server.listenTcp((uint16_t)parseNumber(serveAddress, "port", UINT16_MAX)) << endl;
+            }
+            else
             {
-                algo->initialize(subGame, sampleDraws);
+                server.listenUnix(serveAddress);
+                cout << "Serving on " << serveAddress << endl;
             }
-        };
+            std::signal(SIGINT, [](int) { stopRunning = true; });
+            server.run(stopRunning);
+            const LatencyHistogram &latencies = server.getLatencies();
+            cout << "Served " << latencies.getCount() << " requests, p50=" << latencies.getPercentile(50) / 1000.0 << "us p99=" << latencies.getPercentile(99) / 1000.0 << "us" << endl;
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        return 0;
     }
 
-    //successes per algorithm per subgame
-    std::vector<std::vector<std::unordered_map<size_t, size_t>>> successes(
-        predictionAlgorithms.size(), std::vector<std::unordered_map<size_t, size_t>>(game.getSubGames().size()));
+    //sample size (currently at 2/3 of total data)
+    const size_t SampleSize = 2 * TotalDraws / 3;
 
-    //iterate the rest of the data and create the predictions
-    {
-        LOTTERY_PROFILE(CreatePredictions);
-        for (size_t testDrawIndex = SampleSize; testDrawIndex < TotalDraws - 1; ++testDrawIndex)
-        {
-            //for each subgame
-            for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
-            {
-                const SubGame &subGame = game.getSubGames()[subGameIndex];
+    //the backtest
+    Backtest backtest(game, predictionAlgorithms, SampleSize);
 
-                //current draw
-                const Draw &currentDraw = subGame.getDraws()[testDrawIndex];
+    backtest.setResultCache(resultCache.get());
 
-                //create the previous draw range
-                DrawVectorRange previousDraws(subGame.getDraws().begin(), subGame.getDraws().begin() + testDrawIndex);
+    //initialize each the algorithm for each subgame
+    {
+        LOTTERY_PROFILE(InitializeAlgorithms);
+        backtest.initialize();
+    }
 
-                //for each algorithm
-                for (size_t algoIndex = 0; algoIndex < predictionAlgorithms.size(); ++algoIndex)
-                {
-                    const auto &algo = predictionAlgorithms[algoIndex];
-
-                    Prediction prediction;
-                    prediction.count = subGame.getNumberCount() * 2;
-
-                    //get the prediction
-                    algo->predict(subGame, previousDraws, prediction);
-
-                    //count how many numbers from the current draw are within the prediction
-                    size_t numbersFound = 0;
-                    for (const Number number : currentDraw)
-                    {
-                        if (prediction.numbers.find(number) != prediction.numbers.end())
-                        {
-                            ++numbersFound;
-                        }
-                    }
-
-                    //set up the relevant count
-                    ++successes[algoIndex][subGameIndex][numbersFound];
-                }
-            }
+    //continue from the last checkpoint, if requested
+    const std::string checkpointFileName = std::string(outDir) + "/Data/Test.checkpoint";
+    if (resume)
+    {
+        try
+        {
+            backtest.loadCheckpoint(checkpointFileName);
+            cout << "Resuming from draw " << backtest.getTestDrawIndex() << endl;
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
         }
     }
 
-    //finalize the algorithms for each subgame
+    //record the count of numbers found per draw, if requested
+    HitTrace trace;
+    if (hitTrace)
     {
-        LOTTERY_PROFILE(FinalizeAlgorithms);
-        for (size_t i = 0; i < game.getSubGames().size(); ++i)
+        try
         {
-            const SubGame &subGame = game.getSubGames()[i];
-            for (const auto &algo : predictionAlgorithms)
-            {
-                algo->finalize(subGame, subGame.getDraws());
-            }
-        };
+            trace.open(std::string(outDir) + "/Data/Test.hits", predictionAlgorithms, game, SampleSize, resume ? backtest.getTestDrawIndex() : SampleSize);
+        }
+        catch (const std::runtime_error &error)
+        {
+            cout << "Error: " << error.what() << endl;
+            return -1;
+        }
+        backtest.setHitTrace(&trace);
     }
 
-    //find out how many columns the output file must have
-    size_t totalColumns = 1;
-    for (size_t i = 0; i < game.getSubGames().size(); ++i)
+    //the algorithm names, for the reports
+    std::vector<std::string> algorithmNames;
+    for (const auto &algo : predictionAlgorithms)
     {
-        totalColumns += game.getSubGames()[i].getNumberCount() + 1;
+        algorithmNames.push_back(algo->getName());
     }
 
-    //open the output file
-    CSVFile outFile;
-    const std::string outFileName = std::string(outDir) + "/Data/Test.csv";
-    outFile.openForWriting(outFileName.c_str(), totalColumns);
-
-    //write the header
-    outFile.write("Algorithm", 12);
-    for (size_t i = 0; i < game.getSubGames().size(); ++i)
+    //iterate the rest of the data and create the predictions,
+    //saving a checkpoint after each interval of draws;
+    //when pipelined, the results so far are also written after each interval
+    const std::string reportFileName = std::string(outDir) + "/Data/Test.csv";
+    try
     {
-        const SubGame &subGame = game.getSubGames()[i];
-        for (size_t success = 0; success <= subGame.getNumberCount(); ++success)
+        LOTTERY_PROFILE(CreatePredictions);
+        if (pipeline)
+        {
+            backtest.runPipelined(PipelineCapacity, checkpointInterval, [&](const Backtest::Progress &progress)
+            {
+                //replaced by renaming, so that readers never see a half-written report
+                writeBacktestReport(reportFileName + ".tmp", game, algorithmNames, progress.successes, progress.testDrawIndex - SampleSize, progress.latencies);
+                std::filesystem::rename(reportFileName + ".tmp", reportFileName);
+                backtest.saveCheckpoint(checkpointFileName, progress);
+            });
+        }
+        else
         {
-            std::stringstream stream;
-            stream << subGame.getName() << '_' << success;
-            outFile.write(stream.str(), 8);
+            while (!backtest.run(checkpointInterval))
+            {
+                trace.flush();
+                backtest.saveCheckpoint(checkpointFileName);
+            }
         }
+        trace.close();
+    }
+    catch (const std::exception &error)
+    {
+        cout << "Error: " << error.what() << endl;
+        return -1;
     }
 
-    const size_t TestSize = TotalDraws - SampleSize;
-
-    //write the algorithm results
-    for (size_t algoIndex = 0; algoIndex < predictionAlgorithms.size(); ++algoIndex)
+    //finalize the algorithms for each subgame
     {
-        const auto &algo = predictionAlgorithms[algoIndex];
+        LOTTERY_PROFILE(FinalizeAlgorithms);
+        backtest.finalize();
+    }
 
-        outFile.write(algo->getName(), 12);
+    //write the results
+    writeBacktestReport(reportFileName, game, algorithmNames, backtest.getSuccesses(), backtest.getTestSize(), backtest.getLatencies());
 
-        for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
-        {
-            const SubGame &subGame = game.getSubGames()[subGameIndex];
+    //the run is complete; the checkpoint is no longer needed
+    std::remove(checkpointFileName.c_str());
 
-            for (size_t success = 0; success <= subGame.getNumberCount(); ++success)
-            {
-                const size_t count = successes[algoIndex][subGameIndex][success];
-                const double percentage = count * 100.0 / TestSize;
-                outFile.writePercent(percentage, 8, 3);
-            }
-        }
+    //report the memory used by the run
+    if (MemoryTracker::isEnabled())
+    {
+        MemoryTracker::report();
     }
 
     return 0;
@@ -0,0 +1,74 @@
+#ifndef LOTTERY_ALIGNEDALLOCATOR_HPP
+#define LOTTERY_ALIGNEDALLOCATOR_HPP
+
+
+#include <cstddef>
+#include <new>
+
+
+namespace Lottery
+{
+
+
+    ///size of a cache line.
+    static constexpr size_t CacheLineSize = 64;
+
+
+    /**
+        Allocator which returns memory aligned to the given alignment;
+        by default, to the size of a cache line.
+     */
+    template <class T, size_t Alignment = CacheLineSize> class AlignedAllocator
+    {
+    public:
+        static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0);
+
+        ///value type.
+        typedef T value_type;
+
+        ///rebinds the allocator to another type.
+        template <class U> struct rebind
+        {
+            typedef AlignedAllocator<U, Alignment> other;
+        };
+
+        ///the default constructor.
+        AlignedAllocator() noexcept
+        {
+        }
+
+        ///copy constructor from allocator of other type.
+        template <class U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept
+        {
+        }
+
+        ///allocates memory for the given count of objects.
+        T *allocate(size_t count)
+        {
+            return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+        }
+
+        ///frees memory.
+        void deallocate(T *ptr, size_t) noexcept
+        {
+            ::operator delete(ptr, std::align_val_t(Alignment));
+        }
+
+        ///all instances are equal.
+        template <class U> bool operator == (const AlignedAllocator<U, Alignment> &) const noexcept
+        {
+            return true;
+        }
+
+        ///all instances are equal.
+        template <class U> bool operator != (const AlignedAllocator<U, Alignment> &) const noexcept
+        {
+            return false;
+        }
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_ALIGNEDALLOCATOR_HPP
@@ -0,0 +1,768 @@
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <thread>
+#include "Backtest.hpp"
+#include "BinaryIO.hpp"
+#include "BoundedQueue.hpp"
+#include "CSVFile.hpp"
+#include "PredictionAlgorithmFactory.hpp"
+#include "Profile.hpp"
+
+
+namespace Lottery
+{
+
+
+    //checkpoint file identification
+    static constexpr uint32_t CheckpointMagic = 0x4b43544c;
+    static constexpr uint32_t CheckpointVersion = 6;
+
+
+    //number of test draws predicted in one call of predictBatch
+    static constexpr size_t PredictBatchSize = 16;
+
+
+    //returns the first draws of a subgame for an algorithm; empty if the algorithm does not read them
+    static DrawVectorRange getAlgorithmDraws(const PredictionAlgorithm &algorithm, const SubGame &subGame, size_t endDrawIndex)
+    {
+        return algorithm.readsDraws() ? DrawVectorRange(subGame.getDraws().begin(), subGame.getDraws().begin() + endDrawIndex) : DrawVectorRange();
+    }
+
+
+    //constructor
+    Backtest::Backtest(
+        const Game &game,
+        const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms,
+        size_t sampleSize)
+        : m_game(game)
+        , m_predictionAlgorithms(predictionAlgorithms)
+        , m_sampleSize(sampleSize)
+        , m_beginDrawIndex(sampleSize)
+        , m_testDrawIndex(sampleSize)
+        , m_endDrawIndex(game.getDrawsCount() > 0 ? game.getDrawsCount() - 1 : 0)
+        , m_successes(predictionAlgorithms.size(), game.getSubGames())
+        , m_cached(predictionAlgorithms.size(), std::vector<bool>(game.getSubGames().size(), false))
+        , m_hits(predictionAlgorithms.size() * game.getSubGames().size(), HitTrace::NotComputed)
+        , m_latencies(predictionAlgorithms.size() * game.getSubGames().size())
+    {
+        m_predictions.reserve(predictionAlgorithms.size() * game.getSubGames().size() * PredictBatchSize);
+
+        //names for the trace events
+        std::string allNames;
+        for (const auto &algo : predictionAlgorithms)
+        {
+            m_algorithmNames.push_back(algo->getName());
+            m_traceNames.push_back(Trace::intern(algo->getName()));
+            allNames += (allNames.empty() ? "" : "+") + algo->getName();
+        }
+        m_traceName = Trace::intern(allNames);
+    }
+
+
+    //limits the test to a range of draws
+    void Backtest::setTestDrawRange(size_t beginDrawIndex, size_t endDrawIndex)
+    {
+        if (beginDrawIndex < m_sampleSize || beginDrawIndex > endDrawIndex || endDrawIndex > m_endDrawIndex)
+        {
+            throw std::runtime_error("invalid test draw range");
+        }
+        m_beginDrawIndex = beginDrawIndex;
+        m_testDrawIndex = beginDrawIndex;
+        m_endDrawIndex = endDrawIndex;
+    }
+
+
+    //initializes the algorithms
+    void Backtest::initialize()
+    {
+        //find the cached results
+        for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+        {
+            for (size_t subGameIndex = 0; subGameIndex < m_game.getSubGames().size(); ++subGameIndex)
+            {
+                std::vector<SuccessTable::Counter> counters;
+                m_cached[algoIndex][subGameIndex] = _isCached() && m_predictionAlgorithms[algoIndex]->isDeterministic() && m_resultCache->find(
+                    ResultCacheKey::create(*m_predictionAlgorithms[algoIndex], m_game.getSubGames()[subGameIndex], m_sampleSize, m_endDrawIndex),
+                    counters) && m_successes.set(algoIndex, subGameIndex, counters);
+            }
+        }
+
+        for (size_t i = 0; i < m_game.getSubGames().size(); ++i)
+        {
+            const SubGame &subGame = m_game.getSubGames()[i];
+
+            //initialize the algorithms
+            for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+            {
+                if (!m_cached[algoIndex][i])
+                {
+                    const uint64_t startTime = Profiler::now();
+                    m_predictionAlgorithms[algoIndex]->initialize(subGame, getAlgorithmDraws(*m_predictionAlgorithms[algoIndex], subGame, m_sampleSize));
+                    m_latencies[algoIndex * m_game.getSubGames().size() + i].initialize.record(Profiler::now() - startTime);
+                }
+            }
+        }
+    }
+
+
+    //predicts the test draws
+    bool Backtest::run(size_t maxDrawCount)
+    {
+        const size_t remainingDrawCount = m_endDrawIndex > m_testDrawIndex ? m_endDrawIndex - m_testDrawIndex : 0;
+        const size_t beginDrawIndex = m_testDrawIndex;
+        const size_t endDrawIndex = m_testDrawIndex + std::min(maxDrawCount, remainingDrawCount);
+
+        LOTTERY_PROFILE_DETAIL(Run, m_traceName, beginDrawIndex, endDrawIndex);
+
+        while (m_testDrawIndex < endDrawIndex)
+        {
+            const size_t batchBeginDrawIndex = m_testDrawIndex;
+            const size_t batchEndDrawIndex = std::min(batchBeginDrawIndex + PredictBatchSize, endDrawIndex);
+            _predict(batchBeginDrawIndex, batchEndDrawIndex, m_predictions, m_arena);
+            for (; m_testDrawIndex < batchEndDrawIndex; ++m_testDrawIndex)
+            {
+                _score(m_testDrawIndex, m_predictions.data() + (m_testDrawIndex - batchBeginDrawIndex), batchEndDrawIndex - batchBeginDrawIndex);
+            }
+        }
+
+        //the results were just completed
+        if (isComplete() && endDrawIndex > beginDrawIndex)
+        {
+            _storeResults();
+        }
+
+        return isComplete();
+    }
+
+
+    //a stage of a pipelined run: the items added to it are processed in order, by one task of the group at a time,
+    //started when an item is added while no task runs, so that no thread waits for the other stages
+    template <class T> class PipelineStage
+    {
+    public:
+        //the capacity must be a power of two, not less than the number of items in the pipeline
+        PipelineStage(TaskGroup &group, size_t capacity, std::function<void(T &&item)> process)
+            : m_group(group)
+            , m_queue(capacity)
+            , m_process(std::move(process))
+        {
+        }
+
+        //adds an item
+        void push(T &&item)
+        {
+            m_queue.tryPush(std::move(item));
+            _start(1);
+        }
+
+        //adds items, before any of them is processed
+        void push(std::vector<T> &items)
+        {
+            for (T &item : items)
+            {
+                m_queue.tryPush(std::move(item));
+            }
+            _start(items.size());
+        }
+
+    private:
+        TaskGroup &m_group;
+        BoundedQueue<T> m_queue;
+        std::function<void(T &&item)> m_process;
+        std::atomic<size_t> m_pendingCount{ 0 };
+
+        //counts added items; starts a task to process them, if none runs
+        void _start(size_t count)
+        {
+            if (count > 0 && m_pendingCount.fetch_add(count) == 0)
+            {
+                m_group.run([this]() { _run(); });
+            }
+        }
+
+        //processes the items until there are none left; after a failure, the items are discarded
+        void _run()
+        {
+            do
+            {
+                //the item is in the queue before it is counted
+                T item;
+                while (!m_queue.tryPop(item))
+                {
+                    std::this_thread::yield();
+                }
+                if (!m_group.isCancelled())
+                {
+                    m_process(std::move(item));
+                }
+            } while (m_pendingCount.fetch_sub(1) > 1);
+        }
+    };
+
+
+    //predicts the test draws in a pipeline
+    bool Backtest::runPipelined(size_t queueCapacity, size_t reportInterval, const ReportFunction &report, TaskScheduler &scheduler)
+    {
+        //a batch of draws, passed along the stages and then reused for the next draws;
+        //the arena is declared first, so that the predictions are destroyed before it
+        struct Step
+        {
+            size_t beginDrawIndex = 0;
+            size_t endDrawIndex = 0;
+            StepArena arena;
+            std::vector<Prediction> predictions;
+
+            //set if the progress is reported after the last draw of the batch
+            bool reported = false;
+            Progress progress;
+            std::vector<uint8_t> hits;
+        };
+
+        const size_t beginDrawIndex = m_testDrawIndex;
+        const size_t endDrawIndex = std::max(m_testDrawIndex, m_endDrawIndex);
+        if (beginDrawIndex == endDrawIndex)
+        {
+            return isComplete();
+        }
+
+        LOTTERY_PROFILE_DETAIL(RunPipelined, m_traceName, beginDrawIndex, endDrawIndex);
+
+        queueCapacity = std::max<size_t>(queueCapacity, 2);
+        while (queueCapacity & (queueCapacity - 1))
+        {
+            queueCapacity &= queueCapacity - 1;
+        }
+        const size_t stepCount = std::max<size_t>(queueCapacity / PredictBatchSize, 2);
+        reportInterval = std::max<size_t>(reportInterval, 1);
+
+        //sets the draws of a step, up to the next report point; false if there are no draws left;
+        //once the pipeline runs, it is called by the reporting stage only
+        size_t nextDrawIndex = beginDrawIndex;
+        auto assignDraws = [&](Step &step)
+        {
+            if (nextDrawIndex >= endDrawIndex)
+            {
+                return false;
+            }
+            const size_t reportDrawIndex = beginDrawIndex + ((nextDrawIndex - beginDrawIndex) / reportInterval + 1) * reportInterval;
+            step.beginDrawIndex = nextDrawIndex;
+            step.endDrawIndex = std::min({ nextDrawIndex + PredictBatchSize, reportDrawIndex, endDrawIndex });
+            step.reported = step.endDrawIndex == reportDrawIndex || step.endDrawIndex == endDrawIndex;
+            nextDrawIndex = step.endDrawIndex;
+            return true;
+        };
+
+        TaskGroup group(scheduler);
+        std::function<void(std::unique_ptr<Step> &&step)> restart;
+
+        //reporting stage; it also reuses the steps for the next draws
+        PipelineStage<std::unique_ptr<Step>> reporting(group, stepCount, [&](std::unique_ptr<Step> &&step)
+        {
+            if (step->reported)
+            {
+                if (m_hitTrace)
+                {
+                    m_hitTrace->write(step->hits);
+                }
+                report(step->progress);
+            }
+            restart(std::move(step));
+        });
+
+        //scoring stage
+        PipelineStage<std::unique_ptr<Step>> scoring(group, stepCount, [&](std::unique_ptr<Step> &&step)
+        {
+            for (size_t drawIndex = step->beginDrawIndex; drawIndex < step->endDrawIndex; ++drawIndex)
+            {
+                _score(drawIndex, step->predictions.data() + (drawIndex - step->beginDrawIndex), step->endDrawIndex - step->beginDrawIndex);
+            }
+            m_testDrawIndex = step->endDrawIndex;
+            if (step->reported)
+            {
+                step->progress.testDrawIndex = m_testDrawIndex;
+                step->progress.successes = m_successes;
+                if (m_hitTrace)
+                {
+                    m_hitTrace->takeRecords(step->hits);
+                }
+            }
+            reporting.push(std::move(step));
+        });
+
+        //prediction stage; the states of the algorithms are saved at the report points
+        PipelineStage<std::unique_ptr<Step>> prediction(group, stepCount, [&](std::unique_ptr<Step> &&step)
+        {
+            _predict(step->beginDrawIndex, step->endDrawIndex, step->predictions, step->arena);
+            if (step->reported)
+            {
+                step->progress.latencies = m_latencies;
+                step->progress.algorithmStates.clear();
+                for (const auto &algo : m_predictionAlgorithms)
+                {
+                    std::stringstream state;
+                    algo->saveState(state);
+                    step->progress.algorithmStates.push_back(state.str());
+                }
+            }
+            scoring.push(std::move(step));
+        });
+
+        //feature extraction stage
+        PipelineStage<std::unique_ptr<Step>> features(group, stepCount, [&](std::unique_ptr<Step> &&step)
+        {
+            _extractFeatures();
+            prediction.push(std::move(step));
+        });
+
+        restart = [&](std::unique_ptr<Step> &&step)
+        {
+            if (assignDraws(*step))
+            {
+                features.push(std::move(step));
+            }
+        };
+
+        //the first steps are added together, so that steps reused by the reporting stage are added after them
+        std::vector<std::unique_ptr<Step>> steps;
+        for (size_t i = 0; i < stepCount; ++i)
+        {
+            auto step = std::make_unique<Step>();
+            step->predictions.reserve(m_predictionAlgorithms.size() * m_game.getSubGames().size() * PredictBatchSize);
+            if (!assignDraws(*step))
+            {
+                break;
+            }
+            steps.push_back(std::move(step));
+        }
+        features.push(steps);
+
+        //the waiting thread executes the stages too
+        group.wait();
+
+        //the results were just completed
+        if (isComplete())
+        {
+            _storeResults();
+        }
+
+        return isComplete();
+    }
+
+
+    //computes the draw columns and the built-in features
+    void Backtest::_extractFeatures() const
+    {
+        for (const SubGame &subGame : m_game.getSubGames())
+        {
+            subGame.getDrawsByColumn();
+            for (size_t featureId = 0; featureId < FeatureStore::BuiltinFeatureCount; ++featureId)
+            {
+                subGame.getFeature(featureId);
+            }
+        }
+    }
+
+
+    //predicts a batch of test draws
+    void Backtest::_predict(size_t beginDrawIndex, size_t endDrawIndex, std::vector<Prediction> &predictions, StepArena &arena)
+    {
+        const size_t drawCount = endDrawIndex - beginDrawIndex;
+
+        //the predictions of the previous batch are destroyed before their memory is released
+        predictions.clear();
+        arena.reset();
+        for (size_t i = 0; i < m_predictionAlgorithms.size() * m_game.getSubGames().size() * drawCount; ++i)
+        {
+            predictions.emplace_back(&arena);
+        }
+
+        for (size_t subGameIndex = 0; subGameIndex < m_game.getSubGames().size(); ++subGameIndex)
+        {
+            const SubGame &subGame = m_game.getSubGames()[subGameIndex];
+
+            //for each algorithm
+            for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+            {
+                //skip the results served from the cache
+                if (m_cached[algoIndex][subGameIndex])
+                {
+                    continue;
+                }
+
+                const size_t cellIndex = algoIndex * m_game.getSubGames().size() + subGameIndex;
+
+                Prediction *cellPredictions = predictions.data() + cellIndex * drawCount;
+                for (size_t i = 0; i < drawCount; ++i)
+                {
+                    cellPredictions[i].count = subGame.getNumberCount() * 2;
+                }
+
+                //get the predictions
+                LOTTERY_PROFILE_DETAIL(PredictBatch, m_traceNames[algoIndex], subGameIndex, beginDrawIndex);
+                const uint64_t startTime = Profiler::now();
+                m_predictionAlgorithms[algoIndex]->predictBatch(subGame, beginDrawIndex, endDrawIndex, cellPredictions);
+                const uint64_t duration = Profiler::now() - startTime;
+                m_latencies[cellIndex].predict.record(duration / drawCount, drawCount);
+                m_latencies[cellIndex].predictBatch.record(duration);
+            }
+        }
+    }
+
+
+    //scores the predictions of a test draw
+    void Backtest::_score(size_t drawIndex, const Prediction *predictions, size_t batchDrawCount)
+    {
+        for (size_t subGameIndex = 0; subGameIndex < m_game.getSubGames().size(); ++subGameIndex)
+        {
+            const SubGame &subGame = m_game.getSubGames()[subGameIndex];
+
+            for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+            {
+                if (m_cached[algoIndex][subGameIndex])
+                {
+                    continue;
+                }
+
+                const size_t cellIndex = algoIndex * m_game.getSubGames().size() + subGameIndex;
+                const Prediction &prediction = predictions[cellIndex * batchDrawCount];
+
+                //count how many numbers from the current draw are within the prediction;
+                //the numbers are read from the layout loaded, so that scoring does not build the rows
+                size_t numbersFound = 0;
+                for (size_t position = 0; position < subGame.getNumberCount(); ++position)
+                {
+                    if (prediction.numbers.find(subGame.getNumber(drawIndex, position)) != prediction.numbers.end())
+                    {
+                        ++numbersFound;
+                    }
+                }
+
+                //set up the relevant count
+                m_successes.increment(algoIndex, subGameIndex, numbersFound);
+                m_hits[cellIndex] = (uint8_t)numbersFound;
+            }
+        }
+
+        //trace the result of the draw
+        if (m_hitTrace)
+        {
+            m_hitTrace->record(m_hits.data());
+        }
+    }
+
+
+    //finalizes the algorithms
+    void Backtest::finalize()
+    {
+        for (size_t i = 0; i < m_game.getSubGames().size(); ++i)
+        {
+            const SubGame &subGame = m_game.getSubGames()[i];
+            for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+            {
+                if (!m_cached[algoIndex][i])
+                {
+                    const uint64_t startTime = Profiler::now();
+                    m_predictionAlgorithms[algoIndex]->finalize(subGame, getAlgorithmDraws(*m_predictionAlgorithms[algoIndex], subGame, subGame.getDrawsCount()));
+                    m_latencies[algoIndex * m_game.getSubGames().size() + i].finalize.record(Profiler::now() - startTime);
+                }
+            }
+        }
+    }
+
+
+    //stores the computed results into the cache
+    void Backtest::_storeResults() const
+    {
+        if (!_isCached())
+        {
+            return;
+        }
+
+        for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+        {
+            for (size_t subGameIndex = 0; subGameIndex < m_game.getSubGames().size(); ++subGameIndex)
+            {
+                if (!m_cached[algoIndex][subGameIndex] && m_predictionAlgorithms[algoIndex]->isDeterministic())
+                {
+                    m_resultCache->store(
+                        ResultCacheKey::create(*m_predictionAlgorithms[algoIndex], m_game.getSubGames()[subGameIndex], m_sampleSize, m_endDrawIndex),
+                        m_successes.get(algoIndex, subGameIndex));
+                }
+            }
+        }
+    }
+
+
+    //returns the current state
+    Backtest::Progress Backtest::_getProgress() const
+    {
+        Progress progress;
+        progress.testDrawIndex = m_testDrawIndex;
+        progress.successes = m_successes;
+        progress.latencies = m_latencies;
+        for (const auto &algo : m_predictionAlgorithms)
+        {
+            std::stringstream state;
+            algo->saveState(state);
+            progress.algorithmStates.push_back(state.str());
+        }
+        return progress;
+    }
+
+
+    //saves the checkpoint
+    void Backtest::saveCheckpoint(const std::string &filename) const
+    {
+        saveCheckpoint(filename, _getProgress());
+    }
+
+
+    //saves the checkpoint of a progress
+    void Backtest::saveCheckpoint(const std::string &filename, const Progress &progress) const
+    {
+        const std::string tempFilename = filename + ".tmp";
+
+        {
+            std::ofstream file(tempFilename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            if (!file.is_open())
+            {
+                throw std::runtime_error("the checkpoint file could not be opened for writing");
+            }
+
+            //header
+            writeBinary(file, CheckpointMagic);
+            writeBinary(file, CheckpointVersion);
+            writeBinary(file, (uint64_t)m_game.getDrawsCount());
+            writeBinary(file, (uint64_t)m_game.getSubGames().size());
+            writeBinary(file, (uint64_t)m_sampleSize);
+            writeBinary(file, (uint64_t)progress.testDrawIndex);
+            writeBinary(file, (uint64_t)m_predictionAlgorithms.size());
+
+            for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+            {
+                writeBinary(file, m_algorithmNames[algoIndex]);
+
+                //successes and durations; cached successes are complete, the others are up to the test draw
+                for (size_t subGameIndex = 0; subGameIndex < m_game.getSubGames().size(); ++subGameIndex)
+                {
+                    writeBinary(file, (uint8_t)m_cached[algoIndex][subGameIndex]);
+                    writeBinary(file, progress.successes.get(algoIndex, subGameIndex));
+                    writeBinary(file, progress.latencies[algoIndex * m_game.getSubGames().size() + subGameIndex]);
+                }
+
+                //algorithm state, stored with its size so that it can be validated on load
+                writeBinary(file, progress.algorithmStates[algoIndex]);
+            }
+
+            file.flush();
+            if (!file.good())
+            {
+                throw std::runtime_error("the checkpoint file could not be written");
+            }
+        }
+
+        //replace the previous checkpoint
+        std::error_code error;
+        std::filesystem::rename(tempFilename, filename, error);
+        if (error)
+        {
+            throw std::runtime_error("the checkpoint file could not be renamed: " + error.message());
+        }
+    }
+
+
+    //loads the checkpoint
+    void Backtest::loadCheckpoint(const std::string &filename)
+    {
+        std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("the checkpoint file could not be opened for reading");
+        }
+
+        //header
+        if (readBinary<uint32_t>(file) != CheckpointMagic || readBinary<uint32_t>(file) != CheckpointVersion)
+        {
+            throw std::runtime_error("invalid checkpoint file");
+        }
+        if (readBinary<uint64_t>(file) != m_game.getDrawsCount() ||
+            readBinary<uint64_t>(file) != m_game.getSubGames().size() ||
+            readBinary<uint64_t>(file) != m_sampleSize)
+        {
+            throw std::runtime_error("the checkpoint does not match the loaded game");
+        }
+
+        const size_t testDrawIndex = (size_t)readBinary<uint64_t>(file);
+        if (testDrawIndex < m_sampleSize || testDrawIndex > m_endDrawIndex)
+        {
+            throw std::runtime_error("invalid checkpoint file");
+        }
+
+        if (readBinary<uint64_t>(file) != m_predictionAlgorithms.size())
+        {
+            throw std::runtime_error("the checkpoint does not match the prediction algorithms");
+        }
+
+        SuccessTable successes(m_predictionAlgorithms.size(), m_game.getSubGames());
+        std::vector<AlgorithmLatencies> latencies(m_latencies.size());
+
+        for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+        {
+            const auto &algo = m_predictionAlgorithms[algoIndex];
+
+            if (readBinary<std::string>(file) != algo->getName())
+            {
+                throw std::runtime_error("the checkpoint does not match the prediction algorithms");
+            }
+
+            //successes and durations
+            for (size_t subGameIndex = 0; subGameIndex < m_game.getSubGames().size(); ++subGameIndex)
+            {
+                const size_t cellIndex = algoIndex * m_game.getSubGames().size() + subGameIndex;
+                const bool cached = readBinary<uint8_t>(file) != 0;
+                const std::vector<SuccessTable::Counter> counters = readBinary<std::vector<SuccessTable::Counter>>(file);
+                readBinary(file, latencies[cellIndex]);
+
+                //complete results from the cache cannot be continued by computing the rest of the draws
+                if (cached && !m_cached[algoIndex][subGameIndex])
+                {
+                    throw std::runtime_error("the checkpoint contains cached results which are not in the cache");
+                }
+
+                //results that are now cached are kept from the cache instead of the partial ones
+                if (m_cached[algoIndex][subGameIndex])
+                {
+                    successes.set(algoIndex, subGameIndex, m_successes.get(algoIndex, subGameIndex));
+                    latencies[cellIndex] = m_latencies[cellIndex];
+                }
+                else if (!successes.set(algoIndex, subGameIndex, counters))
+                {
+                    throw std::runtime_error("invalid checkpoint file");
+                }
+            }
+
+            //algorithm state
+            std::stringstream state(readBinary<std::string>(file));
+            algo->loadState(state);
+        }
+
+        m_testDrawIndex = testDrawIndex;
+        m_successes = std::move(successes);
+        m_latencies = std::move(latencies);
+    }
+
+
+    //tests a single algorithm
+    SuccessTable backtestAlgorithm(
+        const Game &game,
+        const std::string &algorithm,
+        size_t sampleSize,
+        const ResultCache *resultCache,
+        std::vector<AlgorithmLatencies> *latencies)
+    {
+        LOTTERY_PROFILE(BacktestAlgorithm);
+
+        std::vector<std::unique_ptr<PredictionAlgorithm>> predictionAlgorithms;
+        predictionAlgorithms.push_back(createPredictionAlgorithm(algorithm, game));
+
+        Backtest backtest(game, predictionAlgorithms, sampleSize);
+        backtest.setResultCache(resultCache);
+        backtest.initialize();
+        backtest.run();
+        backtest.finalize();
+
+        if (latencies)
+        {
+            *latencies = backtest.getLatencies();
+        }
+
+        return backtest.getSuccesses();
+    }
+
+
+    //writes the report
+    void writeBacktestReport(
+        const std::string &filename,
+        const Game &game,
+        const std::vector<std::string> &algorithms,
+        const SuccessTable &successes,
+        size_t testSize,
+        const std::vector<AlgorithmLatencies> &latencies)
+    {
+        //the durations reported
+        static const char *phaseNames[] = { "Initialize", "Predict", "PredictBatch", "Finalize" };
+        static const LatencyHistogram AlgorithmLatencies::*phases[] = { &AlgorithmLatencies::initialize, &AlgorithmLatencies::predict, &AlgorithmLatencies::predictBatch, &AlgorithmLatencies::finalize };
+        static const char *statNames[] = { "p50", "p99", "p99.9", "max" };
+        static const double percentiles[] = { 50, 99, 99.9, 100 };
+        const size_t latencyColumnCount = latencies.empty() ? 0 : 4 * 4;
+
+        //find out how many columns the output file must have
+        size_t totalColumns = 1;
+        for (size_t i = 0; i < game.getSubGames().size(); ++i)
+        {
+            totalColumns += game.getSubGames()[i].getNumberCount() + 1 + latencyColumnCount;
+        }
+
+        //open the output file
+        CSVFile outFile;
+        outFile.openForWriting(filename, totalColumns);
+
+        //write the header
+        outFile.write("Algorithm", 12);
+        for (size_t i = 0; i < game.getSubGames().size(); ++i)
+        {
+            const SubGame &subGame = game.getSubGames()[i];
+            for (size_t success = 0; success <= subGame.getNumberCount(); ++success)
+            {
+                std::stringstream stream;
+                stream << subGame.getName() << '_' << success;
+                outFile.write(stream.str(), 8);
+            }
+        }
+        for (size_t i = 0; i < game.getSubGames().size() && latencyColumnCount; ++i)
+        {
+            for (const char *phaseName : phaseNames)
+            {
+                for (const char *statName : statNames)
+                {
+                    outFile.write(game.getSubGames()[i].getName() + '_' + phaseName + '_' + statName);
+                }
+            }
+        }
+
+        //write the algorithm results
+        for (size_t algoIndex = 0; algoIndex < algorithms.size(); ++algoIndex)
+        {
+            outFile.write(algorithms[algoIndex], 12);
+
+            for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
+            {
+                const SubGame &subGame = game.getSubGames()[subGameIndex];
+
+                for (size_t success = 0; success <= subGame.getNumberCount(); ++success)
+                {
+                    const size_t count = (size_t)successes.getCount(algoIndex, subGameIndex, success);
+                    const double percentage = count * 100.0 / testSize;
+                    outFile.writePercent(percentage, 8, 3);
+                }
+            }
+
+            //durations in microseconds
+            for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size() && latencyColumnCount; ++subGameIndex)
+            {
+                const AlgorithmLatencies &cell = latencies[algoIndex * game.getSubGames().size() + subGameIndex];
+                for (const auto phase : phases)
+                {
+                    for (const double percentile : percentiles)
+                    {
+                        outFile.write((cell.*phase).getPercentile(percentile) / 1000.0, 6, 3);
+                    }
+                }
+            }
+        }
+    }
+
+
+} //namespace Lottery
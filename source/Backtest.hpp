@@ -0,0 +1,315 @@
+#ifndef LOTTERY_BACKTEST_HPP
+#define LOTTERY_BACKTEST_HPP
+
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "PredictionAlgorithm.hpp"
+#include "ResultCache.hpp"
+#include "SuccessTable.hpp"
+#include "HitTrace.hpp"
+#include "LatencyHistogram.hpp"
+#include "StepArena.hpp"
+#include "TaskScheduler.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Durations of the calls to an algorithm for a subgame, in nanoseconds.
+     */
+    struct AlgorithmLatencies
+    {
+        ///durations of initialize.
+        LatencyHistogram initialize;
+
+        ///durations per predicted draw: the duration of each predictBatch call divided by its draw count, once per draw.
+        LatencyHistogram predict;
+
+        ///durations of predictBatch, one per batch of test draws (up to 16 draws).
+        LatencyHistogram predictBatch;
+
+        ///durations of finalize.
+        LatencyHistogram finalize;
+    };
+
+
+    /**
+        Tests prediction algorithms against the draws of a game.
+        The first draws are used as sample for initializing the algorithms;
+        each of the rest of the draws is predicted from the draws before it.
+        The test draws are predicted in batches, with PredictionAlgorithm::predictBatch.
+     */
+    class Backtest
+    {
+    public:
+        /**
+            The state of a backtest after a test draw, as written into a checkpoint.
+         */
+        struct Progress
+        {
+            ///index of the next draw to test.
+            size_t testDrawIndex = 0;
+
+            ///successes of the draws tested so far.
+            SuccessTable successes;
+
+            ///durations of the algorithm calls so far, as returned by getLatencies.
+            std::vector<AlgorithmLatencies> latencies;
+
+            ///states of the algorithms, as saved by PredictionAlgorithm::saveState.
+            std::vector<std::string> algorithmStates;
+        };
+
+        /**
+            Function which receives the progress of a pipelined run.
+         */
+        typedef std::function<void(const Progress &progress)> ReportFunction;
+
+        /**
+            Constructor.
+            @param game game to test.
+            @param predictionAlgorithms algorithms to test.
+            @param sampleSize number of draws to initialize the algorithms from.
+         */
+        Backtest(
+            const Game &game,
+            const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms,
+            size_t sampleSize);
+
+        /**
+            Sets the cache to serve results from.
+            The results of the algorithm/subgame pairs found in the cache
+            are not computed; the rest are stored in the cache when the test completes.
+            It must be called before initialize.
+            @param resultCache the cache; null to disable caching.
+         */
+        void setResultCache(const ResultCache *resultCache)
+        {
+            m_resultCache = resultCache;
+        }
+
+        /**
+            Sets the trace to record the count of numbers found per test draw into.
+            @param hitTrace the trace; null to disable tracing.
+         */
+        void setHitTrace(HitTrace *hitTrace)
+        {
+            m_hitTrace = hitTrace;
+        }
+
+        /**
+            Limits the test to a range of the test draws, i.e. for splitting a backtest across processes;
+            the successes of the ranges of a test add up to the successes of the whole test.
+            It must be called before initialize. Results of partial ranges are not cached.
+            @param beginDrawIndex index of the first draw to test; not less than the sample size.
+            @param endDrawIndex index of the draw after the last draw to test; the last draw of the game is not tested.
+            @exception std::runtime_error if the range is not within the test draws.
+         */
+        void setTestDrawRange(size_t beginDrawIndex, size_t endDrawIndex);
+
+        /**
+            Initializes the algorithms from the sample draws.
+         */
+        void initialize();
+
+        /**
+            Predicts the test draws, starting from the current test draw.
+            @param maxDrawCount maximum number of test draws to process.
+            @return true if all the test draws are processed, false otherwise.
+         */
+        bool run(size_t maxDrawCount = SIZE_MAX);
+
+        /**
+            Predicts the remaining test draws in a pipeline of four stages: feature extraction
+            (the draw columns and the built-in features the algorithms read), prediction, scoring,
+            and reporting of the progress, i.e. into a report, a checkpoint and the hit trace.
+            Batches of draws pass through the stages over bounded lock-free queues; each stage processes
+            its batches in order, as tasks of the scheduler, so that the predictions of the next draws
+            are computed while the previous draws are scored and reported. The batches are reused once
+            reported, so a slow stage makes the others wait, without blocking threads of the scheduler.
+            The results are the same as those of run. The batches end at the report points,
+            so that the states of the algorithms are saved into the progress there,
+            and the progress can be written into a checkpoint (see saveCheckpoint).
+            @param queueCapacity number of draws that can be in the pipeline; rounded down to a power of two,
+                and at least two batches of draws.
+            @param reportInterval number of scored draws between reports; the last draw is always reported.
+            @param report function called by the reporting stage, after the hit trace records up to the report are written.
+            @param scheduler scheduler to execute the stages on.
+            @return true if all the test draws are processed.
+            @exception std::runtime_error or any exception thrown by the algorithms or the report function;
+                the stages are stopped.
+         */
+        bool runPipelined(size_t queueCapacity, size_t reportInterval, const ReportFunction &report, TaskScheduler &scheduler = TaskScheduler::getDefault());
+
+        /**
+            Finalizes the algorithms.
+         */
+        void finalize();
+
+        /**
+            Tells if all the test draws are processed.
+         */
+        bool isComplete() const
+        {
+            return m_testDrawIndex >= m_endDrawIndex;
+        }
+
+        ///returns the sample size.
+        size_t getSampleSize() const
+        {
+            return m_sampleSize;
+        }
+
+        ///returns the index of the next draw to test.
+        size_t getTestDrawIndex() const
+        {
+            return m_testDrawIndex;
+        }
+
+        ///returns the size of the test set.
+        size_t getTestSize() const
+        {
+            return m_game.getDrawsCount() - m_sampleSize;
+        }
+
+        ///returns the successes per algorithm per subgame.
+        const SuccessTable &getSuccesses() const
+        {
+            return m_successes;
+        }
+
+        /**
+            Returns the durations of the algorithm calls, per algorithm and subgame,
+            indexed by algorithm index * subgame count + subgame index.
+            Results served from the cache have no durations.
+         */
+        const std::vector<AlgorithmLatencies> &getLatencies() const
+        {
+            return m_latencies;
+        }
+
+        /**
+            Writes the state of the backtest into a checkpoint file.
+            The file is first written under a temporary name
+            and then renamed, so that an existing checkpoint
+            is never left half-written.
+            @param filename name of the checkpoint file.
+            @exception std::runtime_error if there was an error.
+         */
+        void saveCheckpoint(const std::string &filename) const;
+
+        /**
+            Writes a progress of a pipelined run into a checkpoint file, as saveCheckpoint does.
+            It can be called from the report function.
+            @param filename name of the checkpoint file.
+            @param progress the progress.
+            @exception std::runtime_error if there was an error.
+         */
+        void saveCheckpoint(const std::string &filename, const Progress &progress) const;
+
+        /**
+            Restores the state of the backtest from a checkpoint file.
+            It must be called after initialize.
+            @param filename name of the checkpoint file.
+            @exception std::runtime_error if there was an error
+                or the checkpoint does not belong to this backtest,
+                or results cached when the checkpoint was saved are no longer cached.
+         */
+        void loadCheckpoint(const std::string &filename);
+
+    private:
+        const Game &m_game;
+        const std::vector<std::unique_ptr<PredictionAlgorithm>> &m_predictionAlgorithms;
+        size_t m_sampleSize;
+        size_t m_beginDrawIndex;
+        size_t m_testDrawIndex;
+        size_t m_endDrawIndex;
+        SuccessTable m_successes;
+        const ResultCache *m_resultCache = nullptr;
+        std::vector<std::vector<bool>> m_cached;
+        HitTrace *m_hitTrace = nullptr;
+        std::vector<uint8_t> m_hits;
+        std::vector<AlgorithmLatencies> m_latencies;
+        StepArena m_arena;
+        std::vector<Prediction> m_predictions;
+        std::vector<std::string> m_algorithmNames;
+        std::vector<const char *> m_traceNames;
+        const char *m_traceName;
+
+        //computes the draw columns and the built-in features, if not computed yet;
+        //they are computed for all the draws on first request
+        void _extractFeatures() const;
+
+        //predicts a batch of test draws, into a prediction per algorithm, subgame and draw,
+        //with the predictions of the draws of an algorithm and subgame consecutive;
+        //the predictions of the previous batch are destroyed, and their arena is reset
+        void _predict(size_t beginDrawIndex, size_t endDrawIndex, std::vector<Prediction> &predictions, StepArena &arena);
+
+        //scores the predictions of a test draw; the prediction of each algorithm and subgame
+        //is at its index times the count of draws of the batch
+        void _score(size_t drawIndex, const Prediction *predictions, size_t batchDrawCount);
+
+        //returns the current state
+        Progress _getProgress() const;
+
+        //stores the computed results into the cache
+        void _storeResults() const;
+
+        //returns true if the results are served from and stored into the cache
+        bool _isCached() const
+        {
+            return m_resultCache && m_beginDrawIndex == m_sampleSize && m_endDrawIndex + 1 == m_game.getDrawsCount();
+        }
+    };
+
+
+    /**
+        Tests a single algorithm against a game.
+        @param game game to test.
+        @param algorithm algorithm name and parameters, as accepted by createPredictionAlgorithm.
+        @param sampleSize number of draws to initialize the algorithm from.
+        @param resultCache optional cache of results.
+        @param latencies optional output of the durations of the algorithm calls per subgame.
+        @return the successes of the algorithm per subgame.
+        @exception std::runtime_error if there was an error.
+     */
+    SuccessTable backtestAlgorithm(
+        const Game &game,
+        const std::string &algorithm,
+        size_t sampleSize,
+        const ResultCache *resultCache = nullptr,
+        std::vector<AlgorithmLatencies> *latencies = nullptr);
+
+
+    /**
+        Writes the results of a backtest into a CSV file,
+        with one line per algorithm and one column per subgame and count of numbers found.
+        If latencies are given, columns with the p50, p99, p99.9 and max durations
+        of the initialize, predict, predictBatch and finalize calls per subgame follow, in microseconds;
+        the predict durations are per draw, the predictBatch durations per batch of draws.
+        @param filename name of the file.
+        @param game the game tested.
+        @param algorithms names of the algorithms tested.
+        @param successes successes per algorithm per subgame.
+        @param testSize size of the test set.
+        @param latencies optional durations of the algorithm calls, as returned from Backtest::getLatencies.
+        @exception std::runtime_error if there was an error.
+     */
+    void writeBacktestReport(
+        const std::string &filename,
+        const Game &game,
+        const std::vector<std::string> &algorithms,
+        const SuccessTable &successes,
+        size_t testSize,
+        const std::vector<AlgorithmLatencies> &latencies = std::vector<AlgorithmLatencies>());
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_BACKTEST_HPP
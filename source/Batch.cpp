@@ -0,0 +1,158 @@
+#include <filesystem>
+#include <algorithm>
+#include <sstream>
+#include "Batch.hpp"
+#include "Backtest.hpp"
+#include "CSVFile.hpp"
+
+
+namespace Lottery
+{
+
+
+    //finds the game directories
+    std::vector<std::string> findGameDirectories(const std::string &root)
+    {
+        std::vector<std::string> result;
+
+        std::error_code error;
+        for (std::filesystem::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+        {
+            if (it->is_directory() &&
+                std::filesystem::is_regular_file(it->path() / "Game.csv") &&
+                std::filesystem::is_regular_file(it->path() / "Draws.csv"))
+            {
+                result.push_back(it->path().generic_string());
+            }
+        }
+
+        if (error)
+        {
+            throw std::runtime_error("the directory " + root + " could not be read: " + error.message());
+        }
+
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+
+    //runs the batch
+    std::vector<BatchGameResult> runBatch(
+        const std::string &root,
+        const std::vector<std::string> &algorithms,
+        TaskScheduler &scheduler,
+        const ResultCache *resultCache)
+    {
+        const std::vector<std::string> directories = findGameDirectories(root);
+
+        std::vector<BatchGameResult> results(directories.size());
+
+        //load the games
+        for (size_t i = 0; i < directories.size(); ++i)
+        {
+            BatchGameResult &result = results[i];
+            result.name = std::filesystem::relative(directories[i], root).generic_string();
+            result.algorithms = algorithms;
+            result.game = std::make_shared<Game>();
+        }
+        parallelFor(scheduler, 0, directories.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                try
+                {
+                    results[i].game->load(directories[i] + "/Game.csv", directories[i] + "/Draws.csv");
+                }
+                catch (const std::runtime_error &error)
+                {
+                    throw std::runtime_error(directories[i] + ": " + error.what());
+                }
+            }
+            return true;
+        });
+
+        //test each algorithm against each game; each test sets the successes of its algorithm
+        for (BatchGameResult &result : results)
+        {
+            const Game &game = *result.game;
+            result.successes = SuccessTable(algorithms.size(), game.getSubGames());
+            result.testSize = game.getDrawsCount() - 2 * game.getDrawsCount() / 3;
+        }
+        parallelFor(scheduler, 0, results.size() * algorithms.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t testIndex = begin; testIndex < end; ++testIndex)
+            {
+                BatchGameResult &result = results[testIndex / algorithms.size()];
+                const size_t algoIndex = testIndex % algorithms.size();
+                const Game &game = *result.game;
+
+                //sample size (currently at 2/3 of total data)
+                const SuccessTable successes = backtestAlgorithm(game, algorithms[algoIndex], 2 * game.getDrawsCount() / 3, resultCache);
+                for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
+                {
+                    result.successes.set(algoIndex, subGameIndex, successes.get(0, subGameIndex));
+                }
+            }
+            return true;
+        });
+
+        return results;
+    }
+
+
+    //writes the report
+    void writeBatchReport(const std::string &filename, const std::vector<BatchGameResult> &results)
+    {
+        //find out how many success columns the output file must have
+        size_t maxNumberCount = 0;
+        for (const BatchGameResult &result : results)
+        {
+            for (const SubGame &subGame : result.game->getSubGames())
+            {
+                maxNumberCount = std::max(maxNumberCount, subGame.getNumberCount());
+            }
+        }
+
+        //open the output file
+        CSVFile outFile;
+        outFile.openForWriting(filename, 3 + maxNumberCount + 1);
+
+        //write the header
+        outFile.write("Game", 16);
+        outFile.write("Algorithm", 12);
+        outFile.write("SubGame", 8);
+        for (size_t success = 0; success <= maxNumberCount; ++success)
+        {
+            std::stringstream stream;
+            stream << "Found_" << success;
+            outFile.write(stream.str(), 8);
+        }
+
+        //write the results
+        for (const BatchGameResult &result : results)
+        {
+            for (size_t algoIndex = 0; algoIndex < result.algorithms.size(); ++algoIndex)
+            {
+                for (size_t subGameIndex = 0; subGameIndex < result.game->getSubGames().size(); ++subGameIndex)
+                {
+                    const SubGame &subGame = result.game->getSubGames()[subGameIndex];
+
+                    outFile.write(result.name, 16);
+                    outFile.write(result.algorithms[algoIndex], 12);
+                    outFile.write(subGame.getName(), 8);
+
+                    for (size_t success = 0; success <= subGame.getNumberCount(); ++success)
+                    {
+                        const size_t count = (size_t)result.successes.getCount(algoIndex, subGameIndex, success);
+                        const double percentage = result.testSize ? count * 100.0 / result.testSize : 0;
+                        outFile.writePercent(percentage, 8, 3);
+                    }
+
+                    outFile.beginNewLine();
+                }
+            }
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,81 @@
+#ifndef LOTTERY_BATCH_HPP
+#define LOTTERY_BATCH_HPP
+
+
+#include <memory>
+#include <vector>
+#include <string>
+#include "Game.hpp"
+#include "SuccessTable.hpp"
+#include "ResultCache.hpp"
+#include "TaskScheduler.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Results of backtesting the algorithms against one game.
+     */
+    struct BatchGameResult
+    {
+        ///name of the game; its directory relative to the batch root.
+        std::string name;
+
+        ///the game.
+        std::shared_ptr<Game> game;
+
+        ///names of the algorithms.
+        std::vector<std::string> algorithms;
+
+        ///successes per algorithm per subgame.
+        SuccessTable successes;
+
+        ///size of the test set.
+        size_t testSize = 0;
+    };
+
+
+    /**
+        Finds the game directories under the given root;
+        a game directory contains the files Game.csv and Draws.csv.
+        @param root root directory.
+        @return the game directories, sorted.
+        @exception std::runtime_error if the root could not be read.
+     */
+    std::vector<std::string> findGameDirectories(const std::string &root);
+
+
+    /**
+        Loads all the games under the given root and backtests the given algorithms against them.
+        The games are loaded concurrently; each game/algorithm pair is tested as a separate task.
+        It can be called from a task of the scheduler, since the waiting thread executes queued tasks.
+        @param root root directory.
+        @param algorithms names of the algorithms to test.
+        @param scheduler scheduler to execute the tasks on.
+        @param resultCache optional cache of results.
+        @return the results, one per game.
+        @exception std::runtime_error if there was an error.
+     */
+    std::vector<BatchGameResult> runBatch(
+        const std::string &root,
+        const std::vector<std::string> &algorithms,
+        TaskScheduler &scheduler,
+        const ResultCache *resultCache = nullptr);
+
+
+    /**
+        Writes the results of a batch into a single CSV file,
+        with one line per game, algorithm and subgame.
+        @param filename name of the file.
+        @param results results.
+        @exception std::runtime_error if there was an error.
+     */
+    void writeBatchReport(const std::string &filename, const std::vector<BatchGameResult> &results);
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_BATCH_HPP
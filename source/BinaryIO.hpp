@@ -0,0 +1,125 @@
+#ifndef LOTTERY_BINARYIO_HPP
+#define LOTTERY_BINARYIO_HPP
+
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Writes a trivially copyable value in binary form.
+        @exception std::runtime_error if there was an error.
+     */
+    template <class T> void writeBinary(std::ostream &stream, const T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        if (!stream.good())
+        {
+            throw std::runtime_error("binary write failure");
+        }
+    }
+
+
+    /**
+        Writes a string in binary form, prefixed by its length.
+        @exception std::runtime_error if there was an error.
+     */
+    inline void writeBinary(std::ostream &stream, const std::string &str)
+    {
+        writeBinary(stream, (uint64_t)str.size());
+        stream.write(str.data(), str.size());
+        if (!stream.good())
+        {
+            throw std::runtime_error("binary write failure");
+        }
+    }
+
+
+    /**
+        Writes a vector in binary form, prefixed by its size.
+        @exception std::runtime_error if there was an error.
+     */
+    template <class T, class Alloc> void writeBinary(std::ostream &stream, const std::vector<T, Alloc> &vec)
+    {
+        writeBinary(stream, (uint64_t)vec.size());
+        for (const T &elem : vec)
+        {
+            writeBinary(stream, elem);
+        }
+    }
+
+
+    /**
+        Reads a trivially copyable value in binary form.
+        @exception std::runtime_error if there was an error.
+     */
+    template <class T> void readBinary(std::istream &stream, T &value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        stream.read(reinterpret_cast<char *>(&value), sizeof(T));
+        if (!stream.good())
+        {
+            throw std::runtime_error("binary read failure");
+        }
+    }
+
+
+    /**
+        Reads a string written by writeBinary.
+        @exception std::runtime_error if there was an error.
+     */
+    inline void readBinary(std::istream &stream, std::string &str)
+    {
+        uint64_t size = 0;
+        readBinary(stream, size);
+        str.resize((size_t)size);
+        stream.read(str.data(), size);
+        if (!stream.good())
+        {
+            throw std::runtime_error("binary read failure");
+        }
+    }
+
+
+    /**
+        Reads a vector written by writeBinary.
+        @exception std::runtime_error if there was an error.
+     */
+    template <class T, class Alloc> void readBinary(std::istream &stream, std::vector<T, Alloc> &vec)
+    {
+        uint64_t size = 0;
+        readBinary(stream, size);
+        vec.resize((size_t)size);
+        for (T &elem : vec)
+        {
+            readBinary(stream, elem);
+        }
+    }
+
+
+    /**
+        Reads a value written by writeBinary.
+        @exception std::runtime_error if there was an error.
+     */
+    template <class T> T readBinary(std::istream &stream)
+    {
+        T value{};
+        readBinary(stream, value);
+        return value;
+    }
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_BINARYIO_HPP
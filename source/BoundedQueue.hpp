@@ -0,0 +1,143 @@
+#ifndef LOTTERY_BOUNDEDQUEUE_HPP
+#define LOTTERY_BOUNDEDQUEUE_HPP
+
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <stdexcept>
+#include "AlignedAllocator.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Bounded lock-free queue for many producers and many consumers.
+        Each slot carries a sequence number that tells whether it is free to write
+        or ready to read for the current lap, so that producers and consumers
+        only contend on their own position counter.
+        @param T type of elements; it must be default constructible and move assignable.
+     */
+    template <class T> class BoundedQueue
+    {
+    public:
+        /**
+            Constructor.
+            @param capacity maximum number of elements; it must be a power of two.
+            @exception std::runtime_error if the capacity is not a power of two.
+         */
+        BoundedQueue(size_t capacity)
+            : m_slots(new Slot[capacity])
+            , m_mask(capacity - 1)
+        {
+            if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+            {
+                throw std::runtime_error("the queue capacity must be a power of two");
+            }
+            for (size_t i = 0; i < capacity; ++i)
+            {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator = (const BoundedQueue &) = delete;
+
+        /**
+            Adds an element, if the queue is not full.
+            @param value value to move into the queue.
+            @return true if added, false if the queue is full.
+         */
+        bool tryPush(T &&value)
+        {
+            size_t pos = m_pushPos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Slot &slot = m_slots[pos & m_mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+                if (diff == 0)
+                {
+                    if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        slot.value = std::move(value);
+                        slot.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_pushPos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+            Removes an element, if the queue is not empty.
+            @param value the result.
+            @return true if removed, false if the queue is empty.
+         */
+        bool tryPop(T &value)
+        {
+            size_t pos = m_popPos.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Slot &slot = m_slots[pos & m_mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+                if (diff == 0)
+                {
+                    if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(slot.value);
+                        slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = m_popPos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        ///returns the number of elements pushed so far.
+        size_t getPushCount() const
+        {
+            return m_pushPos.load(std::memory_order_acquire);
+        }
+
+        ///returns the number of elements popped so far.
+        size_t getPopCount() const
+        {
+            return m_popPos.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        const size_t m_mask;
+        alignas(CacheLineSize) std::atomic<size_t> m_pushPos{ 0 };
+        alignas(CacheLineSize) std::atomic<size_t> m_popPos{ 0 };
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_BOUNDEDQUEUE_HPP
@@ -1,5 +1,6 @@
 #include <sstream>
 #include <iomanip>
+#include <limits>
 #include "CSVFile.hpp"
 
 
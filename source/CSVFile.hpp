@@ -106,7 +106,7 @@ namespace Lottery
         void beginNewLine();
 
         ///returns the column count.
-        const size_t getColumnCount() const
+        size_t getColumnCount() const
         {
             return m_columnCount;
         }
@@ -0,0 +1,215 @@
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "ColumnStatistics.hpp"
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LOTTERY_SSE2
+#include <emmintrin.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    //computes the moments
+    ColumnMoments computeColumnMoments(const Number *numbers, size_t count)
+    {
+        static_assert(sizeof(Number) == 1, "the kernel works on 8-bit numbers");
+
+        ColumnMoments result;
+        result.count = count;
+        size_t i = 0;
+
+        #ifdef LOTTERY_SSE2
+        //16 numbers per step: sums with _mm_sad_epu8, squares with _mm_madd_epi16 on 16-bit halves;
+        //the 32-bit square sums are flushed into 64 bits before they can overflow
+        const __m128i zero = _mm_setzero_si128();
+        __m128i sum = zero;
+        while (i + 16 <= count)
+        {
+            __m128i squares = zero;
+            const size_t blockEnd = std::min(count - (count - i) % 16, i + 16 * 8192);
+            for (; i < blockEnd; i += 16)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(numbers + i));
+                sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+                const __m128i low = _mm_unpacklo_epi8(v, zero);
+                const __m128i high = _mm_unpackhi_epi8(v, zero);
+                squares = _mm_add_epi32(squares, _mm_madd_epi16(low, low));
+                squares = _mm_add_epi32(squares, _mm_madd_epi16(high, high));
+            }
+            alignas(16) uint32_t squareParts[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(squareParts), squares);
+            result.sumOfSquares += (uint64_t)squareParts[0] + squareParts[1] + squareParts[2] + squareParts[3];
+        }
+        alignas(16) uint64_t sumParts[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(sumParts), sum);
+        result.sum = sumParts[0] + sumParts[1];
+        #endif
+
+        for (; i < count; ++i)
+        {
+            result.sum += numbers[i];
+            result.sumOfSquares += (uint64_t)numbers[i] * numbers[i];
+        }
+
+        return result;
+    }
+
+
+    //computes the histogram
+    void computeColumnHistogram(const Number *numbers, size_t count, Number minNumber, size_t numberSpan, uint32_t *histogram)
+    {
+        //four partial histograms, so that runs of the same number do not serialize on one counter
+        uint32_t partial[4][256] = {};
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            ++partial[0][numbers[i]];
+            ++partial[1][numbers[i + 1]];
+            ++partial[2][numbers[i + 2]];
+            ++partial[3][numbers[i + 3]];
+        }
+        for (; i < count; ++i)
+        {
+            ++partial[0][numbers[i]];
+        }
+
+        //numbers outside of the range have no counter in the histogram
+        const size_t endNumber = std::min<size_t>(minNumber + numberSpan, 256);
+        for (size_t number = 0; number < 256; ++number)
+        {
+            if ((number < minNumber || number >= endNumber) && (partial[0][number] | partial[1][number] | partial[2][number] | partial[3][number]))
+            {
+                throw std::runtime_error("number outside of the number range");
+            }
+        }
+
+        for (size_t number = minNumber; number < endNumber; ++number)
+        {
+            histogram[number - minNumber] += partial[0][number] + partial[1][number] + partial[2][number] + partial[3][number];
+        }
+    }
+
+
+    //computes the transitions
+    void computeColumnTransitions(const Number *numbers, size_t count, Number minNumber, size_t numberSpan, uint32_t *transitions)
+    {
+        for (size_t i = 1; i < count; ++i)
+        {
+            ++transitions[(numbers[i - 1] - minNumber) * numberSpan + (numbers[i] - minNumber)];
+        }
+    }
+
+
+    //computes the windowed quantiles
+    void computeWindowedQuantiles(
+        const Number *numbers,
+        size_t count,
+        size_t windowSize,
+        double quantile,
+        Number minNumber,
+        size_t numberSpan,
+        Number *result)
+    {
+        if (windowSize == 0)
+        {
+            throw std::runtime_error("the window size must not be 0");
+        }
+
+        //the number at the rank is tracked as the window slides: index is its position in the histogram,
+        //and below is the count of numbers of the window before it; each step moves it by a few positions
+        std::vector<uint32_t> histogram(numberSpan, 0);
+        size_t index = 0;
+        size_t below = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            //slide the window: the number which leaves it, then the new one
+            if (i >= windowSize)
+            {
+                const size_t oldIndex = numbers[i - windowSize] - minNumber;
+                --histogram[oldIndex];
+                below -= oldIndex < index;
+            }
+            const size_t newIndex = numbers[i] - minNumber;
+            ++histogram[newIndex];
+            below += newIndex < index;
+
+            //move to the number at the rank of the quantile: the first one whose cumulative count exceeds the rank
+            const size_t size = std::min(i + 1, windowSize);
+            const size_t rank = std::min((size_t)(quantile * (size - 1) + 0.5), size - 1);
+            while (below > rank)
+            {
+                below -= histogram[--index];
+            }
+            while (below + histogram[index] <= rank)
+            {
+                below += histogram[index++];
+            }
+            result[i] = (Number)(minNumber + index);
+        }
+    }
+
+
+    //constructor
+    PositionalDistribution::PositionalDistribution(const SubGame &subGame)
+        : m_subGame(subGame)
+        , m_numberSpan(subGame.getNumberSpan())
+        , m_histograms(subGame.getNumberCount() * subGame.getNumberSpan(), 0)
+        , m_moments(subGame.getNumberCount())
+    {
+    }
+
+
+    //adds draws in bulk
+    void PositionalDistribution::advanceTo(size_t endDrawIndex)
+    {
+        endDrawIndex = std::min(endDrawIndex, m_subGame.getDrawsCount());
+        if (endDrawIndex <= m_endDrawIndex)
+        {
+            return;
+        }
+
+        for (size_t column = 0; column < m_subGame.getNumberCount(); ++column)
+        {
+            const Number *numbers = m_subGame.getDrawsByColumn()[column].data() + m_endDrawIndex;
+            const size_t count = endDrawIndex - m_endDrawIndex;
+            computeColumnHistogram(numbers, count, m_subGame.getMinNumber(), m_numberSpan, m_histograms.data() + column * m_numberSpan);
+            const ColumnMoments moments = computeColumnMoments(numbers, count);
+            m_moments[column].count += moments.count;
+            m_moments[column].sum += moments.sum;
+            m_moments[column].sumOfSquares += moments.sumOfSquares;
+        }
+
+        m_endDrawIndex = endDrawIndex;
+    }
+
+
+    //adds the next draw
+    bool PositionalDistribution::advance()
+    {
+        if (m_endDrawIndex >= m_subGame.getDrawsCount())
+        {
+            return false;
+        }
+
+        const NumberColumnVector &columns = m_subGame.getDrawsByColumn();
+        for (size_t column = 0; column < columns.size(); ++column)
+        {
+            const Number number = columns[column][m_endDrawIndex];
+            ++m_histograms[column * m_numberSpan + (number - m_subGame.getMinNumber())];
+            ColumnMoments &moments = m_moments[column];
+            ++moments.count;
+            moments.sum += number;
+            moments.sumOfSquares += (uint64_t)number * number;
+        }
+
+        ++m_endDrawIndex;
+        return true;
+    }
+
+
+} //namespace Lottery
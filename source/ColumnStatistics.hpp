@@ -0,0 +1,171 @@
+#ifndef LOTTERY_COLUMNSTATISTICS_HPP
+#define LOTTERY_COLUMNSTATISTICS_HPP
+
+
+#include <vector>
+#include <cstdint>
+#include "SubGame.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Sum and sum of squares of a column of numbers.
+     */
+    struct ColumnMoments
+    {
+        ///count of numbers.
+        uint64_t count = 0;
+
+        ///sum of numbers.
+        uint64_t sum = 0;
+
+        ///sum of squares of numbers.
+        uint64_t sumOfSquares = 0;
+
+        ///returns the mean.
+        double getMean() const
+        {
+            return count ? (double)sum / count : 0;
+        }
+
+        ///returns the population variance.
+        double getVariance() const
+        {
+            if (count == 0)
+            {
+                return 0;
+            }
+            const double mean = getMean();
+            return (double)sumOfSquares / count - mean * mean;
+        }
+    };
+
+
+    /**
+        Computes the sum and sum of squares of numbers (vectorized).
+        @param numbers numbers.
+        @param count count of numbers.
+     */
+    ColumnMoments computeColumnMoments(const Number *numbers, size_t count);
+
+
+    /**
+        Counts the occurrences of each number.
+        @param numbers numbers.
+        @param count count of numbers.
+        @param minNumber minimum number.
+        @param numberSpan size of the number range; the histogram has this many counts.
+        @param histogram counts, indexed by number - minNumber; they are added to the existing counts.
+        @exception std::runtime_error if a number is outside of the number range; the histogram is not changed.
+     */
+    void computeColumnHistogram(const Number *numbers, size_t count, Number minNumber, size_t numberSpan, uint32_t *histogram);
+
+
+    /**
+        Counts the transitions between successive numbers of a column.
+        @param numbers numbers.
+        @param count count of numbers.
+        @param minNumber minimum number.
+        @param numberSpan size of the number range.
+        @param transitions counts, indexed by (previous - minNumber) * numberSpan + (next - minNumber);
+            they are added to the existing counts.
+     */
+    void computeColumnTransitions(const Number *numbers, size_t count, Number minNumber, size_t numberSpan, uint32_t *transitions);
+
+
+    /**
+        Computes an order statistic (i.e. the median) of each window of numbers,
+        from a histogram of the window which is updated as the window slides;
+        the position of the statistic in the histogram moves with it, so the time is independent
+        of the window size and, for windows whose statistic changes slowly, close to O(count).
+        @param numbers numbers.
+        @param count count of numbers.
+        @param windowSize size of the window; the first windows are shorter.
+        @param quantile quantile to compute, from 0 to 1; 0.5 for the median.
+        @param minNumber minimum number.
+        @param numberSpan size of the number range.
+        @param result one value per number; the quantile of the window that ends at the number.
+        @exception std::runtime_error if the window size is 0.
+     */
+    void computeWindowedQuantiles(
+        const Number *numbers,
+        size_t count,
+        size_t windowSize,
+        double quantile,
+        Number minNumber,
+        size_t numberSpan,
+        Number *result);
+
+
+    /**
+        Distribution of numbers per draw position (column), over the draws seen so far.
+        It advances one draw at a time, in O(numberCount),
+        so that a walk-forward backtest can use the distribution of every step.
+     */
+    class PositionalDistribution
+    {
+    public:
+        /**
+            Constructor.
+            @param subGame subgame whose draws are counted.
+         */
+        PositionalDistribution(const SubGame &subGame);
+
+        /**
+            Adds the draws up to the given index (exclusive), computing the new part in bulk.
+            @param endDrawIndex index of the draw after the last draw to count.
+         */
+        void advanceTo(size_t endDrawIndex);
+
+        /**
+            Adds the next draw.
+            @return false if there are no more draws.
+         */
+        bool advance();
+
+        ///returns the index of the draw after the last counted draw.
+        size_t getEndDrawIndex() const
+        {
+            return m_endDrawIndex;
+        }
+
+        ///returns the count of the given number at the given position.
+        uint32_t getCount(size_t column, Number number) const
+        {
+            return m_histograms[column * m_numberSpan + (number - m_subGame.getMinNumber())];
+        }
+
+        ///returns the counts of the numbers at the given position, indexed by number - min number.
+        const uint32_t *getHistogram(size_t column) const
+        {
+            return m_histograms.data() + column * m_numberSpan;
+        }
+
+        ///returns the moments of the numbers at the given position.
+        const ColumnMoments &getMoments(size_t column) const
+        {
+            return m_moments[column];
+        }
+
+        ///returns the probability of the given number at the given position.
+        double getProbability(size_t column, Number number) const
+        {
+            return m_endDrawIndex ? (double)getCount(column, number) / m_endDrawIndex : 0;
+        }
+
+    private:
+        const SubGame &m_subGame;
+        size_t m_numberSpan;
+        size_t m_endDrawIndex = 0;
+        std::vector<uint32_t> m_histograms;
+        std::vector<ColumnMoments> m_moments;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_COLUMNSTATISTICS_HPP
@@ -0,0 +1,545 @@
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <sstream>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include "Distributed.hpp"
+#include "Backtest.hpp"
+#include "PredictionAlgorithmFactory.hpp"
+#include "TaskScheduler.hpp"
+#include "Log.hpp"
+#include "parseNumber.hpp"
+
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    //number of attempts to connect to the coordinator, one second apart
+    static constexpr size_t ConnectAttemptCount = 60;
+
+
+    //splits a message into its values
+    static std::vector<std::string> _split(const std::string &line)
+    {
+        std::vector<std::string> result;
+        std::stringstream stream(line);
+        for (std::string value; std::getline(stream, value, '\t');)
+        {
+            result.push_back(value);
+        }
+        return result;
+    }
+
+
+    //constructor
+    Coordinator::Coordinator(const std::vector<Experiment> &experiments, size_t unitDrawCount, std::chrono::seconds unitTimeout)
+        : m_experiments(experiments)
+        , m_unitTimeout(unitTimeout)
+    {
+        unitDrawCount = std::max<size_t>(unitDrawCount, 1);
+
+        std::map<std::string, std::shared_ptr<const Game>> games;
+        for (size_t experimentIndex = 0; experimentIndex < experiments.size(); ++experimentIndex)
+        {
+            const Experiment &experiment = experiments[experimentIndex];
+
+            //load the game once per directory
+            std::shared_ptr<const Game> &game = games[experiment.gameDirectory];
+            if (!game)
+            {
+                try
+                {
+                    auto loadedGame = std::make_shared<Game>();
+                    loadedGame->load(experiment.gameDirectory + "/Game.csv", experiment.gameDirectory + "/Draws.csv");
+                    game = loadedGame;
+                }
+                catch (const std::runtime_error &error)
+                {
+                    throw std::runtime_error(experiment.gameDirectory + ": " + error.what());
+                }
+            }
+            m_games.push_back(game);
+
+            size_t sampleSize;
+            try
+            {
+                sampleSize = experiment.split.getSampleSize(game->getDrawsCount());
+            }
+            catch (const std::runtime_error &error)
+            {
+                throw std::runtime_error(experiment.name + ": " + error.what());
+            }
+            m_sampleSizes.push_back(sampleSize);
+
+            //split the test draws of each algorithm into units; the last draw is not tested
+            m_successes.emplace_back();
+            for (size_t algoIndex = 0; algoIndex < experiment.algorithms.size(); ++algoIndex)
+            {
+                m_successes.back().emplace_back(1, game->getSubGames());
+                for (size_t begin = sampleSize; begin < game->getDrawsCount() - 1; begin += unitDrawCount)
+                {
+                    m_pending.push_back(m_units.size());
+                    m_units.push_back(WorkUnit{ experimentIndex, algoIndex, begin, std::min(begin + unitDrawCount, game->getDrawsCount() - 1) });
+                }
+            }
+        }
+
+        m_completed.resize(m_units.size(), false);
+    }
+
+
+    //listens for workers
+    uint16_t Coordinator::listen(uint16_t port)
+    {
+        m_listener = Socket::listenTcp(port, false);
+        m_listener.setNonBlocking();
+        return m_listener.getPort();
+    }
+
+
+#ifndef _WIN32
+
+
+    //runs the units
+    void Coordinator::run()
+    {
+        while (m_completedCount < m_units.size())
+        {
+            std::vector<pollfd> handles;
+            handles.push_back(pollfd{ m_listener.getHandle(), POLLIN, 0 });
+            for (const std::unique_ptr<Worker> &worker : m_workers)
+            {
+                handles.push_back(pollfd{ worker->socket.getHandle(), POLLIN, 0 });
+            }
+
+            if (::poll(handles.data(), handles.size(), 1000) < 0 && errno != EINTR)
+            {
+                throw std::runtime_error(std::string("poll failed: ") + std::strerror(errno));
+            }
+
+            const auto now = std::chrono::steady_clock::now();
+
+            //accept new workers
+            if (handles[0].revents & POLLIN)
+            {
+                for (Socket socket = m_listener.accept(); socket.isValid(); socket = m_listener.accept())
+                {
+                    socket.setNoDelay();
+                    m_workers.push_back(std::make_unique<Worker>());
+                    m_workers.back()->socket = std::move(socket);
+                    m_workers.back()->lastResultTime = now;
+                }
+            }
+
+            //read the messages of the workers
+            for (size_t i = 1; i < handles.size(); ++i)
+            {
+                Worker &worker = *m_workers[i - 1];
+                if (!(handles[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                {
+                    continue;
+                }
+
+                char buffer[4096];
+                ptrdiff_t size = 0;
+                try
+                {
+                    size = worker.socket.read(buffer, sizeof(buffer));
+                }
+                catch (const std::runtime_error &)
+                {
+                }
+                if (size <= 0)
+                {
+                    _lose(worker, "disconnected");
+                    continue;
+                }
+
+                worker.input.append(buffer, (size_t)size);
+                for (size_t end = worker.input.find('\n'); end != std::string::npos && !worker.lost; end = worker.input.find('\n'))
+                {
+                    const std::string line = worker.input.substr(0, end);
+                    worker.input.erase(0, end + 1);
+                    _process(worker, line);
+                }
+            }
+
+            //lose the workers which do not respond
+            for (const std::unique_ptr<Worker> &worker : m_workers)
+            {
+                if (!worker->lost && !worker->units.empty() && now - worker->lastResultTime > m_unitTimeout)
+                {
+                    _lose(*worker, "timed out");
+                }
+            }
+
+            m_workers.erase(
+                std::remove_if(m_workers.begin(), m_workers.end(), [](const std::unique_ptr<Worker> &worker) { return worker->lost; }),
+                m_workers.end());
+
+            //keep the workers busy
+            for (const std::unique_ptr<Worker> &worker : m_workers)
+            {
+                _issue(*worker);
+            }
+        }
+
+        //release the workers
+        for (const std::unique_ptr<Worker> &worker : m_workers)
+        {
+            try
+            {
+                worker->socket.writeAll("DONE\n", 5);
+            }
+            catch (const std::runtime_error &)
+            {
+            }
+        }
+        m_workers.clear();
+
+        _writeReports();
+    }
+
+
+#else
+
+
+    //runs the units
+    void Coordinator::run()
+    {
+        throw std::runtime_error("the coordinator is not supported on this platform");
+    }
+
+
+#endif
+
+
+    //processes a message of a worker
+    void Coordinator::_process(Worker &worker, const std::string &line)
+    {
+        const std::vector<std::string> values = _split(line);
+        if (values.empty())
+        {
+            return;
+        }
+
+        try
+        {
+            //the number of units the worker runs at the same time
+            if (values[0] == "HELLO" && values.size() == 2)
+            {
+                worker.capacity = parseNumber(values[1], "message value");
+                return;
+            }
+
+            if (values.size() < 2)
+            {
+                throw std::runtime_error("invalid message: " + line);
+            }
+
+            const size_t unitIndex = parseNumber(values[1], "message value");
+            auto it = std::find(worker.units.begin(), worker.units.end(), unitIndex);
+            if (it == worker.units.end())
+            {
+                throw std::runtime_error("result of a unit not issued to the worker");
+            }
+
+            //errors of units are errors of the algorithms or the games; issuing the unit again would not help
+            if (values[0] == "ERROR")
+            {
+                const WorkUnit &unit = m_units[unitIndex];
+                throw std::logic_error(m_experiments[unit.experimentIndex].name + ": " + (values.size() > 2 ? values[2] : std::string()));
+            }
+
+            if (values[0] != "RESULT")
+            {
+                throw std::runtime_error("invalid message: " + line);
+            }
+
+            worker.units.erase(it);
+            worker.lastResultTime = std::chrono::steady_clock::now();
+
+            //a unit issued again may complete twice
+            if (m_completed[unitIndex])
+            {
+                return;
+            }
+
+            const WorkUnit &unit = m_units[unitIndex];
+            const Game &game = *m_games[unit.experimentIndex];
+            if (values.size() != 2 + game.getSubGames().size())
+            {
+                throw std::runtime_error("invalid result: " + line);
+            }
+
+            SuccessTable successes(1, game.getSubGames());
+            for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
+            {
+                std::vector<SuccessTable::Counter> counters;
+                std::stringstream stream(values[2 + subGameIndex]);
+                for (std::string value; std::getline(stream, value, ',');)
+                {
+                    counters.push_back(parseNumber(value, "message value"));
+                }
+                if (!successes.set(0, subGameIndex, counters))
+                {
+                    throw std::runtime_error("invalid result: " + line);
+                }
+            }
+
+            m_successes[unit.experimentIndex][unit.algorithmIndex].add(successes);
+            m_completed[unitIndex] = true;
+            ++m_completedCount;
+        }
+        catch (const std::logic_error &error)
+        {
+            throw std::runtime_error(error.what());
+        }
+        catch (const std::runtime_error &error)
+        {
+            _lose(worker, error.what());
+        }
+    }
+
+
+    //issues units to a worker
+    void Coordinator::_issue(Worker &worker)
+    {
+        while (worker.units.size() < worker.capacity && !m_pending.empty())
+        {
+            const size_t unitIndex = m_pending.front();
+            m_pending.pop_front();
+            if (m_completed[unitIndex])
+            {
+                continue;
+            }
+
+            const WorkUnit &unit = m_units[unitIndex];
+            const Experiment &experiment = m_experiments[unit.experimentIndex];
+            std::stringstream stream;
+            stream << "UNIT\t" << unitIndex
+                << '\t' << experiment.gameDirectory
+                << '\t' << m_games[unit.experimentIndex]->getDrawsCount()
+                << '\t' << m_sampleSizes[unit.experimentIndex]
+                << '\t' << unit.beginDrawIndex
+                << '\t' << unit.endDrawIndex
+                << '\t' << experiment.algorithms[unit.algorithmIndex] << '\n';
+
+            if (worker.units.empty())
+            {
+                worker.lastResultTime = std::chrono::steady_clock::now();
+            }
+            worker.units.push_back(unitIndex);
+
+            try
+            {
+                const std::string message = stream.str();
+                worker.socket.writeAll(message.data(), message.size());
+            }
+            catch (const std::runtime_error &error)
+            {
+                _lose(worker, error.what());
+                return;
+            }
+        }
+    }
+
+
+    //returns the units of a lost worker to the pending units
+    void Coordinator::_lose(Worker &worker, const std::string &reason)
+    {
+        if (worker.lost)
+        {
+            return;
+        }
+
+        for (const size_t unitIndex : worker.units)
+        {
+            if (!m_completed[unitIndex])
+            {
+                m_pending.push_front(unitIndex);
+                ++m_reissuedCount;
+            }
+        }
+
+        LOTTERY_LOG_WARNING("Worker lost (", reason, "); ", worker.units.size(), " units issued again");
+
+        worker.units.clear();
+        worker.lost = true;
+        worker.socket.close();
+    }
+
+
+    //writes the reports
+    void Coordinator::_writeReports() const
+    {
+        for (size_t experimentIndex = 0; experimentIndex < m_experiments.size(); ++experimentIndex)
+        {
+            const Experiment &experiment = m_experiments[experimentIndex];
+            const Game &game = *m_games[experimentIndex];
+
+            SuccessTable successes(experiment.algorithms.size(), game.getSubGames());
+            for (size_t algoIndex = 0; algoIndex < experiment.algorithms.size(); ++algoIndex)
+            {
+                for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
+                {
+                    successes.set(algoIndex, subGameIndex, m_successes[experimentIndex][algoIndex].get(0, subGameIndex));
+                }
+            }
+
+            try
+            {
+                writeBacktestReport(experiment.output, game, experiment.algorithms, successes, game.getDrawsCount() - m_sampleSizes[experimentIndex]);
+            }
+            catch (const std::runtime_error &error)
+            {
+                throw std::runtime_error(experiment.name + ": " + error.what());
+            }
+        }
+    }
+
+
+    //runs units of a coordinator
+    void runWorker(const std::string &host, uint16_t port, TaskScheduler &scheduler)
+    {
+        //the worker may start before the coordinator listens
+        Socket socket;
+        for (size_t attempt = 1; !socket.isValid(); ++attempt)
+        {
+            try
+            {
+                socket = Socket::connectTcp(host, port);
+            }
+            catch (const std::runtime_error &)
+            {
+                if (attempt == ConnectAttemptCount)
+                {
+                    throw;
+                }
+                std::this_thread::sleep_for(std::chrono::seconds(1));
+            }
+        }
+
+        std::mutex mutex;
+        std::atomic<bool> done(false);
+        std::map<std::string, std::shared_future<std::shared_ptr<const Game>>> games;
+
+        //sends a message; if the coordinator is gone, the results are dropped
+        auto send = [&](const std::string &message)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            try
+            {
+                socket.writeAll(message.data(), message.size());
+            }
+            catch (const std::runtime_error &)
+            {
+                done = true;
+            }
+        };
+
+        //the group is destroyed first, waiting for the running units
+        TaskGroup group(scheduler);
+        send("HELLO\t" + std::to_string(scheduler.getThreadCount()) + '\n');
+
+        std::string buffer, line;
+        while (!done && socket.readLine(buffer, line))
+        {
+            const std::vector<std::string> values = _split(line);
+            if (values.empty() || values[0] == "DONE")
+            {
+                break;
+            }
+            if (values[0] != "UNIT" || values.size() != 8)
+            {
+                throw std::runtime_error("invalid message from the coordinator: " + line);
+            }
+
+            const std::string unitId = values[1];
+            const std::string directory = values[2];
+            const size_t drawsCount = parseNumber(values[3], "message value");
+            const size_t sampleSize = parseNumber(values[4], "message value");
+            const size_t beginDrawIndex = parseNumber(values[5], "message value");
+            const size_t endDrawIndex = parseNumber(values[6], "message value");
+            const std::string algorithm = values[7];
+
+            //the game is loaded by the first unit that needs it
+            std::shared_future<std::shared_ptr<const Game>> game;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = games.find(directory);
+                if (it == games.end())
+                {
+                    it = games.emplace(directory, std::async(std::launch::deferred, [directory]()
+                    {
+                        auto game = std::make_shared<Game>();
+                        game->load(directory + "/Game.csv", directory + "/Draws.csv");
+                        return std::shared_ptr<const Game>(game);
+                    }).share()).first;
+                }
+                game = it->second;
+            }
+
+            group.run([=, &send, &done]()
+            {
+                if (done)
+                {
+                    return;
+                }
+
+                std::stringstream result;
+                try
+                {
+                    std::shared_ptr<const Game> loadedGame = game.get();
+                    if (loadedGame->getDrawsCount() != drawsCount)
+                    {
+                        throw std::runtime_error(directory + ": the draws differ from the draws of the coordinator");
+                    }
+
+                    std::vector<std::unique_ptr<PredictionAlgorithm>> predictionAlgorithms;
+                    predictionAlgorithms.push_back(createPredictionAlgorithm(algorithm, *loadedGame));
+
+                    Backtest backtest(*loadedGame, predictionAlgorithms, sampleSize);
+                    backtest.setTestDrawRange(beginDrawIndex, endDrawIndex);
+                    backtest.initialize();
+                    backtest.run();
+                    backtest.finalize();
+
+                    result << "RESULT\t" << unitId;
+                    for (size_t subGameIndex = 0; subGameIndex < loadedGame->getSubGames().size(); ++subGameIndex)
+                    {
+                        const std::vector<SuccessTable::Counter> counters = backtest.getSuccesses().get(0, subGameIndex);
+                        for (size_t i = 0; i < counters.size(); ++i)
+                        {
+                            result << (i == 0 ? '\t' : ',') << counters[i];
+                        }
+                    }
+                }
+                catch (const std::runtime_error &error)
+                {
+                    std::string message = error.what();
+                    std::replace_if(message.begin(), message.end(), [](char c) { return c == '\t' || c == '\n'; }, ' ');
+                    result.str(std::string());
+                    result << "ERROR\t" << unitId << '\t' << message;
+                }
+                result << '\n';
+                send(result.str());
+            });
+        }
+
+        done = true;
+        group.wait();
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,156 @@
+#ifndef LOTTERY_DISTRIBUTED_HPP
+#define LOTTERY_DISTRIBUTED_HPP
+
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Experiment.hpp"
+#include "SuccessTable.hpp"
+#include "Socket.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        A unit of distributed work: an algorithm of an experiment,
+        tested over a range of the test draws.
+     */
+    struct WorkUnit
+    {
+        ///index of the experiment.
+        size_t experimentIndex;
+
+        ///index of the algorithm in the experiment.
+        size_t algorithmIndex;
+
+        ///index of the first draw to test.
+        size_t beginDrawIndex;
+
+        ///index of the draw after the last draw to test.
+        size_t endDrawIndex;
+    };
+
+
+    /**
+        Runs experiments on worker processes, possibly on other machines, over TCP.
+
+        The experiments are split into work units; each unit is an algorithm
+        of an experiment tested over a range of test draws.
+        Workers connect to the coordinator and declare how many units they run at the same time;
+        the coordinator keeps them busy with units and merges the results they stream back.
+        If a worker disconnects, or sends no result within the unit timeout,
+        its units are issued to other workers.
+        When all units are complete, the reports of the experiments are written.
+
+        The game directories of the experiments must be valid paths for the workers too.
+        Algorithms with state across predictions (i.e. random engines) produce
+        different results when their test is split into ranges.
+
+        Messages are lines of tab-separated values:
+            - worker: HELLO <capacity>
+            - coordinator: UNIT <id> <game directory> <draws count> <sample size> <begin draw> <end draw> <algorithm>
+            - worker: RESULT <id> <counters of each subgame, separated by commas>
+            - worker: ERROR <id> <message>
+            - coordinator: DONE
+     */
+    class Coordinator
+    {
+    public:
+        /**
+            Constructor; loads the games of the experiments and splits the experiments into units.
+            @param experiments the experiments.
+            @param unitDrawCount maximum number of test draws per unit.
+            @param unitTimeout time to wait for a result of a worker before its units are issued to other workers.
+            @exception std::runtime_error if there was an error.
+         */
+        Coordinator(
+            const std::vector<Experiment> &experiments,
+            size_t unitDrawCount,
+            std::chrono::seconds unitTimeout = std::chrono::seconds(600));
+
+        /**
+            Listens for workers on the given TCP port, on all interfaces.
+            @param port the port; if 0, a free port is chosen.
+            @return the port.
+            @exception std::runtime_error if there was an error.
+         */
+        uint16_t listen(uint16_t port);
+
+        /**
+            Runs the units on the workers that connect, until all units are complete,
+            then writes the reports.
+            @exception std::runtime_error if there was an error, or a worker reported an error.
+         */
+        void run();
+
+        ///returns the work units.
+        const std::vector<WorkUnit> &getUnits() const
+        {
+            return m_units;
+        }
+
+        ///returns the number of units issued again because their worker was lost.
+        size_t getReissuedCount() const
+        {
+            return m_reissuedCount;
+        }
+
+    private:
+        //a worker connection
+        struct Worker
+        {
+            Socket socket;
+            std::string input;
+            size_t capacity = 0;
+            std::vector<size_t> units;
+            std::chrono::steady_clock::time_point lastResultTime;
+            bool lost = false;
+        };
+
+        const std::vector<Experiment> &m_experiments;
+        std::chrono::seconds m_unitTimeout;
+        std::vector<std::shared_ptr<const Game>> m_games;
+        std::vector<size_t> m_sampleSizes;
+        std::vector<WorkUnit> m_units;
+        std::vector<bool> m_completed;
+        std::deque<size_t> m_pending;
+        std::vector<std::vector<SuccessTable>> m_successes;
+        size_t m_completedCount = 0;
+        size_t m_reissuedCount = 0;
+        Socket m_listener;
+        std::vector<std::unique_ptr<Worker>> m_workers;
+
+        //processes a message of a worker
+        void _process(Worker &worker, const std::string &line);
+
+        //issues pending units to a worker
+        void _issue(Worker &worker);
+
+        //returns the units of a lost worker to the pending units
+        void _lose(Worker &worker, const std::string &reason);
+
+        //writes the reports of the experiments
+        void _writeReports() const;
+    };
+
+
+    /**
+        Runs work units of a coordinator, until the coordinator is done.
+        Games are loaded once and kept for all the units.
+        @param host host of the coordinator.
+        @param port port of the coordinator.
+        @param scheduler scheduler to run the units on; as many units as its threads are requested at the same time.
+        @exception std::runtime_error if the connection to the coordinator failed; connecting is retried for a minute.
+     */
+    void runWorker(const std::string &host, uint16_t port, TaskScheduler &scheduler = TaskScheduler::getDefault());
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_DISTRIBUTED_HPP
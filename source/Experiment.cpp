@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include "Experiment.hpp"
+#include "Backtest.hpp"
+#include "CSVFile.hpp"
+
+
+namespace Lottery
+{
+
+
+    //parses a split
+    ExperimentSplit ExperimentSplit::parse(const std::string &str)
+    {
+        const size_t equals = str.find('=');
+        if (equals == std::string::npos)
+        {
+            throw std::runtime_error("invalid split: " + str);
+        }
+
+        const std::string type = str.substr(0, equals);
+        ExperimentSplit split;
+        if (type == "ratio")
+        {
+            split.type = Ratio;
+        }
+        else if (type == "sample")
+        {
+            split.type = Sample;
+        }
+        else if (type == "test")
+        {
+            split.type = Test;
+        }
+        else
+        {
+            throw std::runtime_error("invalid split: " + str);
+        }
+
+        //the whole value must be a finite number; std::stod skips leading spaces and stops at trailing text
+        const std::string value = str.substr(equals + 1);
+        size_t length = 0;
+        try
+        {
+            if (!value.empty() && !std::isspace((unsigned char)value[0]))
+            {
+                split.value = std::stod(value, &length);
+            }
+        }
+        catch (const std::logic_error &)
+        {
+        }
+        if (length == 0 || length != value.size() || !std::isfinite(split.value))
+        {
+            throw std::runtime_error("invalid split: " + str);
+        }
+
+        return split;
+    }
+
+
+    //returns the sample size
+    size_t ExperimentSplit::getSampleSize(size_t drawsCount) const
+    {
+        double sampleSize = 0;
+        switch (type)
+        {
+            case Ratio:
+                sampleSize = drawsCount * value;
+                break;
+
+            case Sample:
+                sampleSize = value;
+                break;
+
+            case Test:
+                sampleSize = drawsCount - value;
+                break;
+        }
+
+        //at least one draw is needed for the sample and two for the test, since the last draw is not tested;
+        //written so that a NaN size is rejected as well
+        if (!(sampleSize >= 1 && sampleSize + 2 <= drawsCount))
+        {
+            throw std::runtime_error("the split leaves no sample or test draws");
+        }
+
+        return (size_t)sampleSize;
+    }
+
+
+    //loads the experiments
+    std::vector<Experiment> loadExperiments(const std::string &filename)
+    {
+        std::string str;
+
+        CSVFile file;
+        file.openForReading(filename.c_str());
+
+        //read the header
+        for (const char *column : { "Name", "Game", "Algorithms", "Split", "Output" })
+        {
+            file.read(str);
+            if (str != column)
+            {
+                throw std::runtime_error("Invalid experiments file");
+            }
+        }
+
+        //relative paths are relative to the experiments file
+        const std::filesystem::path directory = std::filesystem::path(filename).parent_path();
+
+        std::vector<Experiment> experiments;
+
+        //read the experiments
+        for (;;)
+        {
+            Experiment experiment;
+
+            //if the name is empty, then no more experiments exist
+            file.read(experiment.name);
+            if (experiment.name.empty())
+            {
+                break;
+            }
+
+            //game
+            file.read(str);
+            if (str.empty())
+            {
+                throw std::runtime_error("Invalid experiments file");
+            }
+            experiment.gameDirectory = (directory / str).generic_string();
+
+            //algorithms
+            file.read(str);
+            for (size_t begin = 0; begin < str.size();)
+            {
+                size_t end = str.find('+', begin);
+                if (end == std::string::npos)
+                {
+                    end = str.size();
+                }
+                experiment.algorithms.push_back(str.substr(begin, end - begin));
+                begin = end + 1;
+            }
+            if (experiment.algorithms.empty())
+            {
+                throw std::runtime_error("Invalid experiments file");
+            }
+
+            //split
+            file.read(str);
+            experiment.split = ExperimentSplit::parse(str);
+
+            //output
+            file.read(str);
+            if (str.empty())
+            {
+                throw std::runtime_error("Invalid experiments file");
+            }
+            experiment.output = (directory / str).generic_string();
+
+            experiments.push_back(std::move(experiment));
+        }
+
+        return experiments;
+    }
+
+
+    //returns a game
+    std::shared_ptr<const Game> ExperimentRunner::getGame(const std::string &directory)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_games.find(directory);
+            if (it != m_games.end())
+            {
+                return it->second;
+            }
+        }
+
+        //the game is loaded outside of the lock, so that games are loaded in parallel;
+        //if two threads load the same game, the first one stored is kept
+        auto game = std::make_shared<Game>();
+        try
+        {
+            game->load(directory + "/Game.csv", directory + "/Draws.csv");
+        }
+        catch (const std::runtime_error &error)
+        {
+            throw std::runtime_error(directory + ": " + error.what());
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_games.emplace(directory, std::move(game)).first->second;
+    }
+
+
+    //runs the experiments
+    void ExperimentRunner::run(const std::vector<Experiment> &experiments)
+    {
+        struct Test
+        {
+            SuccessTable successes;
+            std::vector<AlgorithmLatencies> latencies;
+        };
+
+        struct Run
+        {
+            std::shared_ptr<const Game> game;
+            size_t sampleSize;
+            std::vector<Test> tests;
+        };
+
+        std::vector<Run> runs(experiments.size());
+
+        //load the games that are not yet loaded
+        std::vector<std::string> directories;
+        for (const Experiment &experiment : experiments)
+        {
+            directories.push_back(experiment.gameDirectory);
+        }
+        std::sort(directories.begin(), directories.end());
+        directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
+        parallelForEach(m_scheduler, directories, [&](const std::string &directory)
+        {
+            getGame(directory);
+            return true;
+        });
+
+        //get the games and compute the splits before starting any test,
+        //so that errors are reported without leaving tasks running
+        std::vector<std::pair<size_t, size_t>> tests;
+        for (size_t i = 0; i < experiments.size(); ++i)
+        {
+            runs[i].game = getGame(experiments[i].gameDirectory);
+            try
+            {
+                runs[i].sampleSize = experiments[i].split.getSampleSize(runs[i].game->getDrawsCount());
+            }
+            catch (const std::runtime_error &error)
+            {
+                throw std::runtime_error(experiments[i].name + ": " + error.what());
+            }
+            runs[i].tests.resize(experiments[i].algorithms.size());
+            for (size_t algoIndex = 0; algoIndex < experiments[i].algorithms.size(); ++algoIndex)
+            {
+                tests.emplace_back(i, algoIndex);
+            }
+        }
+
+        //test each algorithm of each experiment
+        parallelForEach(m_scheduler, tests, [&](const std::pair<size_t, size_t> &test)
+        {
+            const Experiment &experiment = experiments[test.first];
+            Run &run = runs[test.first];
+            Test &result = run.tests[test.second];
+            try
+            {
+                result.successes = backtestAlgorithm(*run.game, experiment.algorithms[test.second], run.sampleSize, m_resultCache, &result.latencies);
+            }
+            catch (const std::runtime_error &error)
+            {
+                throw std::runtime_error(experiment.name + ": " + error.what());
+            }
+            return true;
+        });
+
+        //write the reports
+        for (size_t i = 0; i < experiments.size(); ++i)
+        {
+            const Experiment &experiment = experiments[i];
+            const Run &run = runs[i];
+
+            SuccessTable successes(experiment.algorithms.size(), run.game->getSubGames());
+            std::vector<AlgorithmLatencies> latencies;
+            try
+            {
+                for (size_t algoIndex = 0; algoIndex < run.tests.size(); ++algoIndex)
+                {
+                    const Test &test = run.tests[algoIndex];
+                    for (size_t subGameIndex = 0; subGameIndex < run.game->getSubGames().size(); ++subGameIndex)
+                    {
+                        successes.set(algoIndex, subGameIndex, test.successes.get(0, subGameIndex));
+                    }
+                    latencies.insert(latencies.end(), test.latencies.begin(), test.latencies.end());
+                }
+
+                writeBacktestReport(experiment.output, *run.game, experiment.algorithms, successes, run.game->getDrawsCount() - run.sampleSize, latencies);
+            }
+            catch (const std::runtime_error &error)
+            {
+                throw std::runtime_error(experiment.name + ": " + error.what());
+            }
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,132 @@
+#ifndef LOTTERY_EXPERIMENT_HPP
+#define LOTTERY_EXPERIMENT_HPP
+
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Game.hpp"
+#include "ResultCache.hpp"
+#include "TaskScheduler.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        How the draws of a game are split into sample and test draws.
+     */
+    struct ExperimentSplit
+    {
+        ///split type.
+        enum Type
+        {
+            ///fraction of the draws used as sample.
+            Ratio,
+
+            ///number of draws used as sample.
+            Sample,
+
+            ///number of the last draws used as test.
+            Test
+        };
+
+        ///split type.
+        Type type = Ratio;
+
+        ///value; meaning depends on type.
+        double value = 2.0 / 3.0;
+
+        /**
+            Parses a split from text: "ratio=<fraction>", "sample=<draws>" or "test=<draws>".
+            @exception std::runtime_error if the text is invalid, i.e. the value is not a finite number or has trailing text.
+         */
+        static ExperimentSplit parse(const std::string &str);
+
+        /**
+            Returns the sample size for the given number of draws.
+            @exception std::runtime_error if the split leaves no sample or test draws.
+         */
+        size_t getSampleSize(size_t drawsCount) const;
+    };
+
+
+    /**
+        Definition of an experiment: a backtest of algorithms against a game.
+     */
+    struct Experiment
+    {
+        ///name of the experiment.
+        std::string name;
+
+        ///directory of the game; it must contain Game.csv and Draws.csv.
+        std::string gameDirectory;
+
+        ///algorithm names and parameters, as accepted by createPredictionAlgorithm.
+        std::vector<std::string> algorithms;
+
+        ///the split of the draws.
+        ExperimentSplit split;
+
+        ///name of the report file.
+        std::string output;
+    };
+
+
+    /**
+        Loads experiments from a spec file.
+        The file has the columns Name, Game, Algorithms, Split and Output;
+        the algorithms are separated by '+', i.e. "Random(seed=5)+A".
+        Relative paths are relative to the directory of the spec file.
+        @param filename name of the spec file.
+        @exception std::runtime_error if there was an error.
+     */
+    std::vector<Experiment> loadExperiments(const std::string &filename);
+
+
+    /**
+        Runs experiments, keeping the loaded games between them.
+     */
+    class ExperimentRunner
+    {
+    public:
+        /**
+            Constructor.
+            @param scheduler scheduler to execute the backtests on.
+            @param resultCache optional cache of results.
+         */
+        ExperimentRunner(TaskScheduler &scheduler, const ResultCache *resultCache = nullptr)
+            : m_scheduler(scheduler)
+            , m_resultCache(resultCache)
+        {
+        }
+
+        /**
+            Returns the game of the given directory, loading it if not already loaded.
+            @exception std::runtime_error if there was an error.
+         */
+        std::shared_ptr<const Game> getGame(const std::string &directory);
+
+        /**
+            Runs the given experiments and writes their reports.
+            The games are loaded concurrently; each experiment/algorithm pair is tested as a separate task.
+            It can be called from a task of the scheduler, since the waiting thread executes queued tasks.
+            @exception std::runtime_error if there was an error.
+         */
+        void run(const std::vector<Experiment> &experiments);
+
+    private:
+        TaskScheduler &m_scheduler;
+        const ResultCache *m_resultCache;
+        std::mutex m_mutex;
+        std::map<std::string, std::shared_ptr<const Game>> m_games;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_EXPERIMENT_HPP
@@ -0,0 +1,259 @@
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include "FeatureStore.hpp"
+#include "SubGame.hpp"
+
+
+namespace Lottery
+{
+
+
+    //sets the result to 0, then adds the value of func for each number of each draw;
+    //the inner loop runs over a column, so it is vectorized
+    template <class F> static void _countColumns(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result, const F &func)
+    {
+        const size_t count = endDrawIndex - beginDrawIndex;
+        std::fill(result, result + count, 0);
+        for (const NumberColumn &column : subGame.getDrawsByColumn())
+        {
+            const Number *numbers = column.data() + beginDrawIndex;
+            for (size_t i = 0; i < count; ++i)
+            {
+                result[i] += func(numbers[i]);
+            }
+        }
+    }
+
+
+    //sum
+    static void _sum(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        _countColumns(subGame, beginDrawIndex, endDrawIndex, result, [](Number number) { return (FeatureValue)number; });
+    }
+
+
+    //spread
+    static void _spread(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        const size_t count = endDrawIndex - beginDrawIndex;
+        std::vector<Number> minNumbers(subGame.getDrawsByColumn()[0].begin() + beginDrawIndex, subGame.getDrawsByColumn()[0].begin() + endDrawIndex);
+        std::vector<Number> maxNumbers(minNumbers);
+        for (const NumberColumn &column : subGame.getDrawsByColumn())
+        {
+            const Number *numbers = column.data() + beginDrawIndex;
+            for (size_t i = 0; i < count; ++i)
+            {
+                minNumbers[i] = std::min(minNumbers[i], numbers[i]);
+                maxNumbers[i] = std::max(maxNumbers[i], numbers[i]);
+            }
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            result[i] = (FeatureValue)maxNumbers[i] - (FeatureValue)minNumbers[i];
+        }
+    }
+
+
+    //odd count
+    static void _oddCount(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        _countColumns(subGame, beginDrawIndex, endDrawIndex, result, [](Number number) { return (FeatureValue)(number & 1); });
+    }
+
+
+    //even count
+    static void _evenCount(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        _countColumns(subGame, beginDrawIndex, endDrawIndex, result, [](Number number) { return (FeatureValue)(~number & 1); });
+    }
+
+
+    //low count
+    static void _lowCount(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        const Number middle = (Number)((subGame.getMinNumber() + subGame.getMaxNumber()) / 2);
+        _countColumns(subGame, beginDrawIndex, endDrawIndex, result, [=](Number number) { return (FeatureValue)(number <= middle); });
+    }
+
+
+    //high count
+    static void _highCount(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        const Number middle = (Number)((subGame.getMinNumber() + subGame.getMaxNumber()) / 2);
+        _countColumns(subGame, beginDrawIndex, endDrawIndex, result, [=](Number number) { return (FeatureValue)(number > middle); });
+    }
+
+
+    //consecutive count
+    static void _consecutiveCount(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        const NumberColumnVector &columns = subGame.getDrawsByColumn();
+        Draw sorted(columns.size());
+        for (size_t i = beginDrawIndex; i < endDrawIndex; ++i)
+        {
+            for (size_t column = 0; column < columns.size(); ++column)
+            {
+                sorted[column] = columns[column][i];
+            }
+            std::sort(sorted.begin(), sorted.end());
+            FeatureValue count = 0;
+            for (size_t j = 1; j < sorted.size(); ++j)
+            {
+                count += sorted[j] == sorted[j - 1] + 1;
+            }
+            result[i - beginDrawIndex] = count;
+        }
+    }
+
+
+    //repeat count
+    static void _repeatCount(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+    {
+        //numbers are 8 bits, so a draw fits in a 256-bit set
+        typedef std::array<uint64_t, 4> NumberSet;
+        const NumberColumnVector &columns = subGame.getDrawsByColumn();
+        auto toSet = [&](size_t drawIndex)
+        {
+            NumberSet set{};
+            for (const NumberColumn &column : columns)
+            {
+                const Number number = column[drawIndex];
+                set[number >> 6] |= 1ull << (number & 63);
+            }
+            return set;
+        };
+
+        NumberSet previous = beginDrawIndex > 0 ? toSet(beginDrawIndex - 1) : NumberSet{};
+        for (size_t i = beginDrawIndex; i < endDrawIndex; ++i)
+        {
+            const NumberSet current = toSet(i);
+            FeatureValue count = 0;
+            for (size_t j = 0; j < current.size(); ++j)
+            {
+                count += (FeatureValue)std::bitset<64>(current[j] & previous[j]).count();
+            }
+            result[i - beginDrawIndex] = count;
+            previous = current;
+        }
+    }
+
+
+    //constructor
+    FeatureStore::FeatureStore()
+    {
+        registerFeature("Sum", &_sum);
+        registerFeature("Spread", &_spread);
+        registerFeature("OddCount", &_oddCount);
+        registerFeature("EvenCount", &_evenCount);
+        registerFeature("LowCount", &_lowCount);
+        registerFeature("HighCount", &_highCount);
+        registerFeature("ConsecutiveCount", &_consecutiveCount);
+        registerFeature("RepeatCount", &_repeatCount);
+        for (Number digit = 0; digit < 10; ++digit)
+        {
+            registerFeature("LastDigit" + std::to_string(digit), [digit](const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)
+            {
+                _countColumns(subGame, beginDrawIndex, endDrawIndex, result, [=](Number number) { return (FeatureValue)(number % 10 == digit); });
+            });
+        }
+    }
+
+
+    //copies the features
+    FeatureStore::FeatureStore(const FeatureStore &store)
+    {
+        std::lock_guard<std::mutex> lock(store.m_mutex);
+        for (const std::unique_ptr<Entry> &entry : store.m_entries)
+        {
+            m_entries.push_back(std::make_unique<Entry>());
+            m_entries.back()->name = entry->name;
+            m_entries.back()->func = entry->func;
+            if (entry->isComputed)
+            {
+                m_entries.back()->column = entry->column;
+                std::call_once(m_entries.back()->computed, []() {});
+                m_entries.back()->isComputed = true;
+            }
+        }
+        m_ids = store.m_ids;
+    }
+
+
+    //registers a feature
+    size_t FeatureStore::registerFeature(const std::string &name, const FeatureFunction &func)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_ids.find(name) != m_ids.end())
+        {
+            throw std::runtime_error("the feature " + name + " is already registered");
+        }
+        m_entries.push_back(std::make_unique<Entry>());
+        m_entries.back()->name = name;
+        m_entries.back()->func = func;
+        m_ids[name] = m_entries.size() - 1;
+        return m_entries.size() - 1;
+    }
+
+
+    //returns the id of a feature
+    size_t FeatureStore::getFeatureId(const std::string &name) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_ids.find(name);
+        if (it == m_ids.end())
+        {
+            throw std::runtime_error("unknown feature " + name);
+        }
+        return it->second;
+    }
+
+
+    //returns the values of a feature
+    const FeatureColumn &FeatureStore::getColumn(const SubGame &subGame, size_t featureId) const
+    {
+        Entry *entry;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (featureId >= m_entries.size())
+            {
+                throw std::runtime_error("unknown feature id " + std::to_string(featureId));
+            }
+            entry = m_entries[featureId].get();
+        }
+
+        //compute the feature outside of the lock, so that other features can be computed in parallel
+        std::call_once(entry->computed, [&]()
+        {
+            const size_t drawCount = subGame.getDrawsCount();
+            entry->column.resize(drawCount);
+            if (drawCount > 0)
+            {
+                entry->func(subGame, 0, drawCount, entry->column.data());
+            }
+            entry->isComputed = true;
+        });
+
+        return entry->column;
+    }
+
+
+    //computes the features of appended draws
+    void FeatureStore::update(const SubGame &subGame)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const size_t drawCount = subGame.getDrawsCount();
+        for (const std::unique_ptr<Entry> &entry : m_entries)
+        {
+            const size_t oldDrawCount = entry->column.size();
+            if (entry->isComputed && oldDrawCount < drawCount)
+            {
+                entry->column.resize(drawCount);
+                entry->func(subGame, oldDrawCount, drawCount, entry->column.data() + oldDrawCount);
+            }
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,155 @@
+#ifndef LOTTERY_FEATURESTORE_HPP
+#define LOTTERY_FEATURESTORE_HPP
+
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include "AlignedAllocator.hpp"
+#include "MemoryTracker.hpp"
+#include "Range.hpp"
+
+
+namespace Lottery
+{
+
+
+    class SubGame;
+
+
+    ///value of a feature of a draw.
+    typedef int32_t FeatureValue;
+
+
+    ///the values of a feature for all the draws of a subgame, aligned for vectorized access.
+    typedef std::vector<FeatureValue, SubsystemAllocator<FeatureValue, MemorySubsystem::Game, AlignedAllocator<FeatureValue>>> FeatureColumn;
+
+
+    ///a range of values of a feature.
+    typedef Range<FeatureColumn> FeatureRange;
+
+
+    /**
+        Function which computes a feature.
+        It receives the subgame and the index range of draws to compute the feature for,
+        and writes the values into the result array, one value per draw.
+     */
+    typedef std::function<void(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, FeatureValue *result)> FeatureFunction;
+
+
+    /**
+        Per-draw features of a subgame, computed lazily, on first request,
+        and then kept for the lifetime of the subgame.
+        The built-in features are computed over the draws by column,
+        so that the loops are vectorized.
+        Custom features can be registered, and are cached the same way.
+        All methods are thread-safe.
+     */
+    class FeatureStore
+    {
+    public:
+        /**
+            Identifiers of the built-in features.
+         */
+        enum BuiltinFeature : size_t
+        {
+            ///sum of the numbers.
+            Sum,
+
+            ///difference between the maximum and the minimum number.
+            Spread,
+
+            ///count of odd numbers.
+            OddCount,
+
+            ///count of even numbers.
+            EvenCount,
+
+            ///count of numbers in the lower half of the number range.
+            LowCount,
+
+            ///count of numbers in the upper half of the number range.
+            HighCount,
+
+            ///count of pairs of consecutive numbers (i.e. 11 and 12).
+            ConsecutiveCount,
+
+            ///count of numbers which were also drawn in the previous draw; 0 for the first draw.
+            RepeatCount,
+
+            ///count of numbers ending in 0; the next features are the counts of numbers ending in 1 to 9.
+            LastDigit0,
+
+            ///number of built-in features.
+            BuiltinFeatureCount = LastDigit0 + 10
+        };
+
+        ///constructor; registers the built-in features.
+        FeatureStore();
+
+        /**
+            Copy constructor; copies the features and the values computed so far.
+            It can be called while other threads read the original.
+         */
+        FeatureStore(const FeatureStore &store);
+
+        FeatureStore &operator = (const FeatureStore &) = delete;
+
+        /**
+            Registers a custom feature.
+            @param name name of the feature.
+            @param func function which computes the feature.
+            @return the identifier of the feature.
+            @exception std::runtime_error if a feature with the same name exists.
+         */
+        size_t registerFeature(const std::string &name, const FeatureFunction &func);
+
+        /**
+            Returns the identifier of a feature.
+            @param name name of the feature.
+            @exception std::runtime_error if the feature does not exist.
+         */
+        size_t getFeatureId(const std::string &name) const;
+
+        /**
+            Returns the values of a feature for all the draws, computing them on first request.
+            The returned column, and iterators and ranges over it, are invalidated by update
+            (i.e. by Game::appendDraws), since the column grows with the draws.
+            @param subGame the subgame this store belongs to.
+            @param featureId identifier of the feature.
+            @exception std::runtime_error if the feature does not exist.
+         */
+        const FeatureColumn &getColumn(const SubGame &subGame, size_t featureId) const;
+
+        /**
+            Computes the values of the computed features for the draws appended to the subgame;
+            features not computed yet are left to be computed on first request.
+            It must not be called concurrently with getColumn; it invalidates the columns it returned.
+            @param subGame the subgame this store belongs to.
+         */
+        void update(const SubGame &subGame);
+
+    private:
+        struct Entry
+        {
+            std::string name;
+            FeatureFunction func;
+            std::once_flag computed;
+            std::atomic<bool> isComputed{ false };
+            FeatureColumn column;
+        };
+
+        mutable std::mutex m_mutex;
+        std::vector<std::unique_ptr<Entry>> m_entries;
+        std::unordered_map<std::string, size_t> m_ids;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_FEATURESTORE_HPP
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <thread>
+#include <sys/stat.h>
+#include "FileWatcher.hpp"
+
+
+#ifdef __linux__
+#include <unistd.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    //constructor
+    FileWatcher::FileWatcher(const std::string &filename, std::chrono::milliseconds pollInterval)
+        : m_filename(filename)
+        , m_pollInterval(std::max(pollInterval, std::chrono::milliseconds(1)))
+    {
+        const size_t separator = filename.find_last_of("/\\");
+        m_name = separator == std::string::npos ? filename : filename.substr(separator + 1);
+
+        #ifdef __linux__
+        m_notifyHandle = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_notifyHandle >= 0)
+        {
+            const std::string folder = separator == std::string::npos ? "." : separator == 0 ? "/" : filename.substr(0, separator);
+            if (inotify_add_watch(m_notifyHandle, folder.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_ATTRIB) < 0)
+            {
+                close(m_notifyHandle);
+                m_notifyHandle = -1;
+            }
+        }
+        #endif
+
+        _checkFile();
+    }
+
+
+    //destructor
+    FileWatcher::~FileWatcher()
+    {
+        #ifdef __linux__
+        if (m_notifyHandle >= 0)
+        {
+            close(m_notifyHandle);
+        }
+        #endif
+    }
+
+
+    //waits for a change
+    bool FileWatcher::wait(std::chrono::milliseconds timeout)
+    {
+        const auto endTime = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const auto waitTime = std::min(m_pollInterval, std::chrono::duration_cast<std::chrono::milliseconds>(endTime - now));
+
+            #ifdef __linux__
+            if (m_notifyHandle >= 0)
+            {
+                pollfd fd{m_notifyHandle, POLLIN, 0};
+                if (poll(&fd, 1, (int)std::max<int64_t>(waitTime.count(), 0)) > 0 && _readEvents())
+                {
+                    _checkFile();
+                    return true;
+                }
+            }
+            else
+            #endif
+            if (waitTime.count() > 0)
+            {
+                std::this_thread::sleep_for(waitTime);
+            }
+
+            if (_checkFile())
+            {
+                return true;
+            }
+
+            if (std::chrono::steady_clock::now() >= endTime)
+            {
+                return false;
+            }
+        }
+    }
+
+
+    //reads the notified events
+    bool FileWatcher::_readEvents()
+    {
+        bool result = false;
+
+        #ifdef __linux__
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            const ssize_t size = read(m_notifyHandle, buffer, sizeof(buffer));
+            if (size <= 0)
+            {
+                break;
+            }
+            for (ssize_t pos = 0; pos < size;)
+            {
+                const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + pos);
+                if (event->len > 0 && m_name == event->name)
+                {
+                    result = true;
+                }
+                pos += sizeof(inotify_event) + event->len;
+            }
+        }
+        #endif
+
+        return result;
+    }
+
+
+    //checks the file
+    bool FileWatcher::_checkFile()
+    {
+        struct stat status;
+        if (stat(m_filename.c_str(), &status) != 0)
+        {
+            return false;
+        }
+
+        const uint64_t size = (uint64_t)status.st_size;
+        const int64_t modificationTime = (int64_t)status.st_mtime;
+        const bool result = size != m_size || modificationTime != m_modificationTime;
+        m_size = size;
+        m_modificationTime = modificationTime;
+        return result;
+    }
+
+
+} //namespace Lottery
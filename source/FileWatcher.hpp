@@ -0,0 +1,78 @@
+#ifndef LOTTERY_FILEWATCHER_HPP
+#define LOTTERY_FILEWATCHER_HPP
+
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Watches a file for changes.
+        On Linux, changes are notified by inotify, watching the folder of the file,
+        so that files replaced by renaming are also seen;
+        elsewhere, or if inotify is not available, the size and modification time
+        of the file are polled.
+        The size and modification time are also checked on each poll interval
+        when inotify is used, for file systems which do not notify changes.
+     */
+    class FileWatcher
+    {
+    public:
+        /**
+            Constructor.
+            @param filename name of the file to watch.
+            @param pollInterval interval of checking the file for changes.
+         */
+        FileWatcher(const std::string &filename, std::chrono::milliseconds pollInterval = std::chrono::milliseconds(250));
+
+        ///destructor.
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher &) = delete;
+        FileWatcher &operator = (const FileWatcher &) = delete;
+
+        ///returns the name of the watched file.
+        const std::string &getFilename() const
+        {
+            return m_filename;
+        }
+
+        ///returns true if changes are notified, false if the file is polled.
+        bool isNotified() const
+        {
+            return m_notifyHandle >= 0;
+        }
+
+        /**
+            Waits for the file to change.
+            Changes may be reported more than once.
+            @param timeout maximum time to wait.
+            @return true if the file changed, false if the timeout expired.
+         */
+        bool wait(std::chrono::milliseconds timeout);
+
+    private:
+        std::string m_filename;
+        std::string m_name;
+        std::chrono::milliseconds m_pollInterval;
+        int m_notifyHandle = -1;
+        uint64_t m_size = 0;
+        int64_t m_modificationTime = 0;
+
+        //reads the events of the notify handle; returns true if any is about the file
+        bool _readEvents();
+
+        //checks the size and modification time of the file
+        bool _checkFile();
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_FILEWATCHER_HPP
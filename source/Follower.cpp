@@ -0,0 +1,118 @@
+#include "Follower.hpp"
+#include "Profile.hpp"
+
+
+namespace Lottery
+{
+
+
+    //constructor
+    Follower::Follower(
+        const Game &game,
+        const std::string &drawsFilename,
+        const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms,
+        std::chrono::milliseconds pollInterval)
+        : m_snapshots(std::make_unique<Game>(game))
+        , m_drawsFilename(drawsFilename)
+        , m_predictionAlgorithms(predictionAlgorithms)
+        , m_watcher(drawsFilename, pollInterval)
+        , m_predictions(predictionAlgorithms.size() * game.getSubGames().size())
+    {
+    }
+
+
+    //initializes the algorithms from all the draws
+    void Follower::initialize()
+    {
+        LOTTERY_PROFILE(FollowInitialize);
+
+        const uint64_t startTime = Profiler::now();
+
+        const SnapshotManager<Game>::Pin game = m_snapshots.pin();
+
+        for (const SubGame &subGame : game->getSubGames())
+        {
+            for (const auto &algo : m_predictionAlgorithms)
+            {
+                algo->initialize(subGame, subGame.getDraws());
+            }
+        }
+
+        _predict(*game);
+
+        m_updateDuration = Profiler::now() - startTime;
+    }
+
+
+    //appends the new draws
+    size_t Follower::update()
+    {
+        LOTTERY_PROFILE(FollowUpdate);
+
+        const uint64_t startTime = Profiler::now();
+
+        //append to a copy of the current version, so that readers of the current version are not affected
+        SnapshotManager<Game>::Pin current = m_snapshots.pin();
+        const size_t oldDrawCount = current->getDrawsCount();
+        auto newGame = std::make_unique<Game>(*current);
+        current.release();
+        const size_t newDrawCount = newGame->appendDraws(m_drawsFilename);
+        if (newDrawCount == 0)
+        {
+            return 0;
+        }
+        m_snapshots.publish(std::move(newGame));
+
+        //feed the new draws to the algorithms
+        const SnapshotManager<Game>::Pin game = m_snapshots.pin();
+        for (const SubGame &subGame : game->getSubGames())
+        {
+            const DrawVectorRange newDraws(subGame.getDraws().begin() + oldDrawCount, subGame.getDraws().end());
+            for (const auto &algo : m_predictionAlgorithms)
+            {
+                algo->update(subGame, newDraws);
+            }
+        }
+
+        _predict(*game);
+
+        m_updateDuration = Profiler::now() - startTime;
+
+        return newDrawCount;
+    }
+
+
+    //waits for changes and updates
+    void Follower::run(const std::function<void(const Follower &follower)> &onPredictions, const std::atomic<bool> &stop)
+    {
+        while (!stop)
+        {
+            if (m_watcher.wait(std::chrono::milliseconds(100)) && update() > 0)
+            {
+                onPredictions(*this);
+            }
+
+            //free the replaced versions that readers no longer pin
+            m_snapshots.reclaim();
+        }
+    }
+
+
+    //predicts the next draw
+    void Follower::_predict(const Game &game)
+    {
+        for (size_t subGameIndex = 0; subGameIndex < game.getSubGames().size(); ++subGameIndex)
+        {
+            const SubGame &subGame = game.getSubGames()[subGameIndex];
+            for (size_t algoIndex = 0; algoIndex < m_predictionAlgorithms.size(); ++algoIndex)
+            {
+                Prediction &prediction = m_predictions[algoIndex * game.getSubGames().size() + subGameIndex];
+                prediction.count = subGame.getNumberCount() * 2;
+                prediction.numbers.clear();
+                m_predictionAlgorithms[algoIndex]->predict(subGame, subGame.getDraws(), prediction);
+            }
+        }
+    }
+
+
+} //namespace Lottery
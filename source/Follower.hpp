@@ -0,0 +1,110 @@
+#ifndef LOTTERY_FOLLOWER_HPP
+#define LOTTERY_FOLLOWER_HPP
+
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "PredictionAlgorithm.hpp"
+#include "FileWatcher.hpp"
+#include "SnapshotManager.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Follows the draws file of a game.
+        The algorithms are initialized from all the draws and predict the next draw;
+        then, whenever draws are appended to the file, only the new lines are parsed,
+        the algorithms are updated with the new draws and predict the next draw again.
+
+        The game is published as versions: new draws are appended to a copy
+        of the current version, which then replaces it. Readers pin a version,
+        from any thread, and can use it while the follower appends.
+     */
+    class Follower
+    {
+    public:
+        /**
+            Constructor.
+            @param game the game, loaded from the draws file; it is copied into the initial version.
+            @param drawsFilename name of the draws file.
+            @param predictionAlgorithms algorithms to predict with.
+            @param pollInterval interval of checking the file for changes, if changes are not notified.
+         */
+        Follower(
+            const Game &game,
+            const std::string &drawsFilename,
+            const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms,
+            std::chrono::milliseconds pollInterval = std::chrono::milliseconds(250));
+
+        /**
+            Initializes the algorithms from all the draws and predicts the next draw.
+         */
+        void initialize();
+
+        /**
+            Appends the new draws of the file, if any; if there are new draws,
+            a new version of the game is published, the algorithms are updated and predict the next draw.
+            If there is an error, the current version is kept.
+            @return the number of new draws.
+            @exception std::runtime_error if there was an error reading the file.
+         */
+        size_t update();
+
+        /**
+            Waits for changes of the draws file and updates, until stopped.
+            @param onPredictions called after each prediction of the next draw.
+            @param stop flag to stop following.
+            @exception std::runtime_error if there was an error reading the file.
+         */
+        void run(const std::function<void(const Follower &follower)> &onPredictions, const std::atomic<bool> &stop);
+
+        ///pins the current version of the game; it can be called from any thread.
+        SnapshotManager<Game>::Pin pinGame() const
+        {
+            return m_snapshots.pin();
+        }
+
+        ///returns true if changes of the file are notified, false if the file is polled.
+        bool isNotified() const
+        {
+            return m_watcher.isNotified();
+        }
+
+        /**
+            Returns the predictions of the next draw, per algorithm and subgame,
+            indexed by algorithm index * subgame count + subgame index.
+            They are of the current version of the game; they must be read by the thread that updates.
+         */
+        const std::vector<Prediction> &getPredictions() const
+        {
+            return m_predictions;
+        }
+
+        ///returns the duration of the last initialization or update, in nanoseconds.
+        uint64_t getUpdateDuration() const
+        {
+            return m_updateDuration;
+        }
+
+    private:
+        SnapshotManager<Game> m_snapshots;
+        const std::string m_drawsFilename;
+        const std::vector<std::unique_ptr<PredictionAlgorithm>> &m_predictionAlgorithms;
+        FileWatcher m_watcher;
+        std::vector<Prediction> m_predictions;
+        uint64_t m_updateDuration = 0;
+
+        //predicts the next draw
+        void _predict(const Game &game);
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_FOLLOWER_HPP
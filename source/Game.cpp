@@ -1,3 +1,7 @@
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
 #include "Game.hpp"
 #include "CSVFile.hpp"
 
@@ -6,8 +10,8 @@ namespace Lottery
 {
 
 
-    //loads the game.
-    void Game::load(const std::string &game, const std::string draws)
+    //loads the game definition
+    void Game::_loadGameFile(const std::string &game)
     {
         std::string str;
 
@@ -43,7 +47,9 @@ namespace Lottery
             throw std::runtime_error("Invalid game file");
         }
 
+        m_subGames.clear();
         m_numberCount = 0;
+        m_firstDrawIndex = 0;
 
         //read subgame
         for (;;)
@@ -96,6 +102,17 @@ namespace Lottery
 
             m_numberCount += numberCount;
         }
+    }
+
+
+
+
+    //loads the game.
+    void Game::load(const std::string &game, const std::string draws, DrawLayout layout)
+    {
+        std::string str;
+
+        _loadGameFile(game);
 
         //draws file
         CSVFile drawsFile;
@@ -111,60 +128,334 @@ namespace Lottery
             }
         }
 
-        //read the numbers into the subgames
+        //read the numbers into the subgames, in the requested layout;
+        //if the first number could not be read, then all the numbers were read
+        std::vector<size_t> numbers(m_numberCount);
         for (;;)
         {
-            for (size_t i = 0; i < m_subGames.size(); ++i)
+            for (size_t i = 0; i < m_numberCount; ++i)
             {
-                SubGame &subGame = m_subGames[i];
+                numbers[i] = 0;
+                drawsFile.read(numbers[i]);
+                if (numbers[0] == 0)
+                {
+                    break;
+                }
+            }
+
+            if (numbers[0] == 0)
+            {
+                break;
+            }
+
+            _addDraw(numbers.data(), layout);
+        }
+
+        _setLayout(layout);
+
+        //find the end of the draws, for appending draws later
+        std::ifstream file;
+        m_drawsFileEnd = _findDataEnd(file, _openDrawsFile(draws, file));
+    }
 
-                size_t num = 0;
 
-                //read the first number
-                drawsFile.read(num);
+    //loads the most recent draws.
+    void Game::loadTail(const std::string &game, const std::string &draws, size_t maxDrawCount, DrawLayout layout)
+    {
+        _loadGameFile(game);
+
+        std::ifstream file;
+        const uint64_t dataBegin = _openDrawsFile(draws, file);
+        const uint64_t dataEnd = _findDataEnd(file, dataBegin);
 
-                //if the first number could not be read,
-                //then all the numbers were read
-                if (i == 0 && num == 0)
+        //scan backwards for the line the requested draws start from
+        uint64_t begin = dataEnd;
+        size_t lineCount = 0;
+        std::vector<char> block(ScanBlockSize);
+        while (begin > dataBegin && lineCount < maxDrawCount)
+        {
+            const uint64_t blockBegin = std::max<uint64_t>(dataBegin, begin > ScanBlockSize ? begin - ScanBlockSize : 0);
+            const size_t blockSize = (size_t)(begin - blockBegin);
+            _readBlock(file, blockBegin, block.data(), blockSize);
+
+            size_t pos = blockSize;
+            for (; pos > 0; --pos)
+            {
+                if (block[pos - 1] == '\n' && ++lineCount == maxDrawCount)
                 {
-                    return;
+                    break;
                 }
+            }
+
+            begin = blockBegin + pos;
+        }
+
+        //the index of the first draw loaded is the count of lines before it
+        m_firstDrawIndex = _countLines(file, dataBegin, begin) + (begin == dataEnd && dataEnd > dataBegin ? 1 : 0);
+
+        _readDraws(file, begin, dataEnd, layout);
+    }
+
+
+    //loads the draws from the given index.
+    void Game::loadFrom(const std::string &game, const std::string &draws, size_t firstDrawIndex, DrawLayout layout)
+    {
+        _loadGameFile(game);
 
-                //check if the first number is ok
-                if (num < subGame.m_minNumber || num > subGame.m_maxNumber)
+        std::ifstream file;
+        const uint64_t dataBegin = _openDrawsFile(draws, file);
+        const uint64_t dataEnd = _findDataEnd(file, dataBegin);
+
+        //skip the lines before the first requested draw
+        uint64_t begin = dataBegin;
+        size_t lineCount = 0;
+        std::vector<char> block(ScanBlockSize);
+        while (begin < dataEnd && lineCount < firstDrawIndex)
+        {
+            const size_t blockSize = (size_t)std::min<uint64_t>(ScanBlockSize, dataEnd - begin);
+            _readBlock(file, begin, block.data(), blockSize);
+
+            size_t pos = 0;
+            while (pos < blockSize && lineCount < firstDrawIndex)
+            {
+                const void *newLine = std::memchr(block.data() + pos, '\n', blockSize - pos);
+                if (!newLine)
                 {
-                    throw std::runtime_error("invalid number in draws file");
+                    pos = blockSize;
+                    break;
                 }
+                pos = (size_t)(static_cast<const char *>(newLine) - block.data()) + 1;
+                ++lineCount;
+            }
 
-                subGame.m_draws.emplace_back(subGame.m_numberCount);
+            begin += pos;
+        }
 
-                //store the first number
-                subGame.m_draws.back()[0] = (Number)num;
+        //if the file has fewer draws, the count of draws is the first index
+        m_firstDrawIndex = begin < dataEnd ? lineCount : lineCount + (dataEnd > dataBegin ? 1 : 0);
 
-                //store the first number in the draws by column
-                subGame.m_drawsByColumn[0].push_back((Number)num);
+        _readDraws(file, begin, dataEnd, layout);
+    }
+
+
+    //appends the draws added to the draws file
+    size_t Game::appendDraws(const std::string &draws)
+    {
+        std::ifstream file(draws, std::ios_base::in | std::ios_base::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("draws file could not be opened");
+        }
+
+        file.seekg(0, std::ios_base::end);
+        const uint64_t fileSize = (uint64_t)file.tellg();
+        if (fileSize < m_drawsFileEnd)
+        {
+            throw std::runtime_error("draws file was truncated");
+        }
+
+        //read the complete lines after the last draw read; a partially written line is read on a later call
+        std::string text((size_t)(fileSize - m_drawsFileEnd), '\0');
+        if (!text.empty())
+        {
+            _readBlock(file, m_drawsFileEnd, &text[0], text.size());
+        }
+        const size_t lineEnd = text.rfind('\n');
+        if (lineEnd == std::string::npos)
+        {
+            return 0;
+        }
+
+        //append the draws to the layouts that are built
+        const size_t oldDrawCount = getDrawsCount();
+        std::vector<DrawLayout> layouts;
+        for (const SubGame &subGame : m_subGames)
+        {
+            layouts.push_back(subGame._getLayout());
+        }
+        _parseDraws(text.data(), text.data() + lineEnd, layouts);
+        m_drawsFileEnd += lineEnd;
+
+        //extend the features computed so far
+        const size_t newDrawCount = getDrawsCount() - oldDrawCount;
+        if (newDrawCount > 0)
+        {
+            for (const SubGame &subGame : m_subGames)
+            {
+                subGame.m_features->update(subGame);
+            }
+        }
+
+        return newDrawCount;
+    }
+
+
+    //opens the draws file and skips the header; returns the position of the first draw
+    uint64_t Game::_openDrawsFile(const std::string &draws, std::ifstream &file)
+    {
+        file.open(draws, std::ios_base::in | std::ios_base::binary);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("draws file could not be opened");
+        }
+
+        std::string header;
+        if (!std::getline(file, header) || header.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            throw std::runtime_error("invalid draws file");
+        }
+
+        return (uint64_t)file.tellg();
+    }
+
+
+    //returns the position after the last non-whitespace character of the draws
+    uint64_t Game::_findDataEnd(std::ifstream &file, uint64_t dataBegin)
+    {
+        file.clear();
+        file.seekg(0, std::ios_base::end);
+        uint64_t end = (uint64_t)file.tellg();
+
+        char block[256];
+        while (end > dataBegin)
+        {
+            const size_t blockSize = (size_t)std::min<uint64_t>(sizeof(block), end - dataBegin);
+            _readBlock(file, end - blockSize, block, blockSize);
+
+            size_t pos = blockSize;
+            while (pos > 0 && std::isspace((unsigned char)block[pos - 1]))
+            {
+                --pos;
+            }
+
+            end -= blockSize - pos;
+            if (pos > 0)
+            {
+                break;
+            }
+        }
+
+        return end;
+    }
+
+
+    //reads a block of the draws file
+    void Game::_readBlock(std::ifstream &file, uint64_t position, char *buffer, size_t size)
+    {
+        file.clear();
+        file.seekg((std::streamoff)position);
+        if (!file.read(buffer, (std::streamsize)size))
+        {
+            throw std::runtime_error("draws file could not be read");
+        }
+    }
+
+
+    //counts the lines between two positions of the draws file
+    size_t Game::_countLines(std::ifstream &file, uint64_t begin, uint64_t end)
+    {
+        size_t result = 0;
+        std::vector<char> block(ScanBlockSize);
+        while (begin < end)
+        {
+            const size_t blockSize = (size_t)std::min<uint64_t>(ScanBlockSize, end - begin);
+            _readBlock(file, begin, block.data(), blockSize);
+            result += (size_t)std::count(block.data(), block.data() + blockSize, '\n');
+            begin += blockSize;
+        }
+        return result;
+    }
+
+
+    //reads the draws between two positions of the draws file
+    void Game::_readDraws(std::ifstream &file, uint64_t begin, uint64_t end, DrawLayout layout)
+    {
+        std::string text((size_t)(end - begin), '\0');
+        if (!text.empty())
+        {
+            _readBlock(file, begin, &text[0], text.size());
+        }
+
+        _parseDraws(text.data(), text.data() + text.size(), std::vector<DrawLayout>(m_subGames.size(), layout));
+        _setLayout(layout);
+        m_drawsFileEnd = end;
+    }
 
-                //read the rest of the numbers
-                for (size_t j = 1; j < subGame.m_numberCount; ++j)
-                {
-                    num = 0;
-                    drawsFile.read(num);
 
-                    //check if the number is valid
-                    if (num < subGame.m_minNumber || num > subGame.m_maxNumber)
+    //parses draws from text
+    void Game::_parseDraws(const char *begin, const char *end, const std::vector<DrawLayout> &layouts)
+    {
+        //values are separated by tabs or commas and lines by new lines, as in CSVFile;
+        //empty lines are skipped, and as with load, the draws end at the first line without a first number
+        std::vector<size_t> numbers(m_numberCount);
+        const char *pos = begin;
+        for (;;)
+        {
+            while (pos < end && std::isspace((unsigned char)*pos))
+            {
+                ++pos;
+            }
+
+            if (pos == end)
+            {
+                break;
+            }
+
+            for (size_t i = 0; i < m_numberCount; ++i)
+            {
+                size_t num = 0;
+                for (; pos < end && *pos != '\t' && *pos != ',' && *pos != '\n'; ++pos)
+                {
+                    if (*pos >= '0' && *pos <= '9')
+                    {
+                        num = num * 10 + (size_t)(*pos - '0');
+                    }
+                    else if (!std::isspace((unsigned char)*pos))
                     {
                         throw std::runtime_error("invalid number in draws file");
                     }
+                }
+                if (pos < end)
+                {
+                    ++pos;
+                }
+                numbers[i] = num;
+            }
 
-                    //store the number
-                    subGame.m_draws.back()[j] = (Number)num;
+            if (numbers[0] == 0)
+            {
+                break;
+            }
 
-                    //store the number in the draws by column
-                    subGame.m_drawsByColumn[j].push_back((Number)num);
-                }
+            const size_t *subGameNumbers = numbers.data();
+            for (size_t i = 0; i < m_subGames.size(); ++i)
+            {
+                m_subGames[i]._addDraw(subGameNumbers, layouts[i]);
+                subGameNumbers += m_subGames[i].m_numberCount;
             }
         }
     }
 
 
-} //namespace Lottery
\ No newline at end of file
+    //adds a draw to the subgames, in the requested layout
+    void Game::_addDraw(const size_t *numbers, DrawLayout layout)
+    {
+        for (SubGame &subGame : m_subGames)
+        {
+            subGame._addDraw(numbers, layout);
+            numbers += subGame.m_numberCount;
+        }
+    }
+
+
+    //the layouts loaded are complete; the others are built on first access
+    void Game::_setLayout(DrawLayout layout)
+    {
+        for (SubGame &subGame : m_subGames)
+        {
+            subGame._setLayout(layout);
+        }
+    }
+
+
+} //namespace Lottery
@@ -2,6 +2,8 @@
 #define LOTTERY_GAME_HPP
 
 
+#include <cstdint>
+#include <iosfwd>
 #include <vector>
 #include "SubGame.hpp"
 
@@ -20,13 +22,61 @@ namespace Lottery
         /**
             Loads the game and the draws
             from the current folder.
+            The feature store and the column statistics read the columns only;
+            the prediction API passes the draws to the algorithms as rows, so backtesting,
+            following or serving a game loaded by column still builds the rows on first use.
             @param game filename of the game definition file.
             @param draws filename of the draws.
+            @param layout layout of the draws to load; the other layout is built on first access.
             @exception std::runtime_exception if there was an error.
          */
         void load(
             const std::string &game = "Game.csv",
-            const std::string draws = "Draws.csv");
+            const std::string draws = "Draws.csv",
+            DrawLayout layout = DrawLayout::Both);
+
+        /**
+            Loads the game and only the most recent draws.
+            The draws file is scanned backwards from its end,
+            so the time taken does not depend on the size of the history.
+            @param game filename of the game definition file.
+            @param draws filename of the draws.
+            @param maxDrawCount maximum number of draws to load.
+            @param layout layout of the draws to load; the other layout is built on first access.
+            @exception std::runtime_exception if there was an error.
+         */
+        void loadTail(
+            const std::string &game,
+            const std::string &draws,
+            size_t maxDrawCount,
+            DrawLayout layout = DrawLayout::Both);
+
+        /**
+            Loads the game and the draws from the given index onwards.
+            @param game filename of the game definition file.
+            @param draws filename of the draws.
+            @param firstDrawIndex index of the first draw to load, in the full history.
+            @param layout layout of the draws to load; the other layout is built on first access.
+            @exception std::runtime_exception if there was an error.
+         */
+        void loadFrom(
+            const std::string &game,
+            const std::string &draws,
+            size_t firstDrawIndex,
+            DrawLayout layout = DrawLayout::Both);
+
+        /**
+            Appends the draws added to the end of the draws file since it was loaded or last appended from.
+            Only complete lines are read; a partially written last line is read on a later call.
+            The draws are added to the layouts built so far, and the features computed so far are extended.
+            The game must not be accessed by other threads during the call.
+            References, iterators and ranges to the draws, columns and feature values of the subgames
+            are invalidated; copy the game first to keep a version valid (see Follower).
+            @param draws filename of the draws; it must be the file the game was loaded from.
+            @return the number of draws appended.
+            @exception std::runtime_exception if there was an error or the file was truncated.
+         */
+        size_t appendDraws(const std::string &draws = "Draws.csv");
 
         ///returns the subgames of this game.
         const std::vector<SubGame> &getSubGames() const
@@ -37,7 +87,17 @@ namespace Lottery
         ///Returns the number of loaded draws.
         size_t getDrawsCount() const
         {
-            return m_subGames.empty() ? 0 : m_subGames[0].m_draws.size();
+            return m_subGames.empty() ? 0 : m_subGames[0].m_drawsCount;
+        }
+
+        /**
+            Returns the index of the first loaded draw in the full history of draws;
+            it is 0 unless the game was loaded with loadTail or loadFrom.
+            The draw at index i of the subgames is the draw at index getFirstDrawIndex() + i of the history.
+         */
+        size_t getFirstDrawIndex() const
+        {
+            return m_firstDrawIndex;
         }
 
         /**
@@ -56,6 +116,38 @@ namespace Lottery
     private:
         std::vector<SubGame> m_subGames;
         size_t m_numberCount = 0;
+        size_t m_firstDrawIndex = 0;
+        uint64_t m_drawsFileEnd = 0;
+
+        //size of blocks the draws file is scanned in
+        static constexpr size_t ScanBlockSize = 1 << 16;
+
+        //loads the game definition file
+        void _loadGameFile(const std::string &game);
+
+        //opens the draws file and skips the header; returns the position of the first draw
+        static uint64_t _openDrawsFile(const std::string &draws, std::ifstream &file);
+
+        //returns the position after the last non-whitespace character of the draws
+        static uint64_t _findDataEnd(std::ifstream &file, uint64_t dataBegin);
+
+        //reads a block of the draws file
+        static void _readBlock(std::ifstream &file, uint64_t position, char *buffer, size_t size);
+
+        //counts the lines between two positions of the draws file
+        static size_t _countLines(std::ifstream &file, uint64_t begin, uint64_t end);
+
+        //reads the draws between two positions of the draws file
+        void _readDraws(std::ifstream &file, uint64_t begin, uint64_t end, DrawLayout layout);
+
+        //parses draws from text, adding them to each subgame in the given layout
+        void _parseDraws(const char *begin, const char *end, const std::vector<DrawLayout> &layouts);
+
+        //adds a draw to the subgames; numbers are all the numbers of the draw
+        void _addDraw(const size_t *numbers, DrawLayout layout);
+
+        //sets the layout of the draws of the subgames
+        void _setLayout(DrawLayout layout);
     };
 
 
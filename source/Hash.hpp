@@ -123,6 +123,7 @@ template <class ...T> struct std::hash<std::tuple<T...>>
         Lottery::forEach(tpl, [&](const auto &elem)
         {
             boost::hash_combine(seed, elem);
+            return true;
         });
         return seed;
     }
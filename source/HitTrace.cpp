@@ -0,0 +1,122 @@
+#include <sstream>
+#include <filesystem>
+#include "HitTrace.hpp"
+#include "BinaryIO.hpp"
+
+
+namespace Lottery
+{
+
+
+    //trace file identification
+    static constexpr uint32_t HitTraceMagic = 0x5448544c;
+    static constexpr uint32_t HitTraceVersion = 1;
+
+
+    //opens the trace
+    void HitTrace::open(
+        const std::string &filename,
+        const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms,
+        const Game &game,
+        size_t firstDrawIndex,
+        size_t resumeDrawIndex)
+    {
+        close();
+
+        //prepare the header
+        std::stringstream header;
+        writeBinary(header, HitTraceMagic);
+        writeBinary(header, HitTraceVersion);
+        writeBinary(header, (uint64_t)firstDrawIndex);
+        writeBinary(header, (uint64_t)predictionAlgorithms.size());
+        for (const auto &algo : predictionAlgorithms)
+        {
+            writeBinary(header, algo->getName());
+        }
+        writeBinary(header, (uint64_t)game.getSubGames().size());
+        for (const SubGame &subGame : game.getSubGames())
+        {
+            writeBinary(header, subGame.getName());
+            writeBinary(header, (uint64_t)subGame.getNumberCount());
+        }
+        const std::string headerData = header.str();
+
+        m_recordSize = predictionAlgorithms.size() * game.getSubGames().size();
+        m_buffer.clear();
+
+        //continue the existing trace
+        if (resumeDrawIndex > firstDrawIndex)
+        {
+            {
+                std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+                std::string existingHeader(headerData.size(), '\0');
+                if (!file.read(existingHeader.data(), existingHeader.size()) || existingHeader != headerData)
+                {
+                    throw std::runtime_error("the hit trace does not match the backtest");
+                }
+            }
+
+            //discard the records after the resumed draw
+            const uintmax_t size = headerData.size() + (resumeDrawIndex - firstDrawIndex) * m_recordSize;
+            std::error_code error;
+            if (std::filesystem::file_size(filename, error) < size || error)
+            {
+                throw std::runtime_error("the hit trace is incomplete");
+            }
+            std::filesystem::resize_file(filename, size, error);
+            if (error)
+            {
+                throw std::runtime_error("the hit trace could not be truncated: " + error.message());
+            }
+
+            m_file.open(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+            if (!m_file.is_open())
+            {
+                throw std::runtime_error("the hit trace could not be opened for writing");
+            }
+            return;
+        }
+
+        //new trace
+        m_file.open(filename, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if (!m_file.is_open())
+        {
+            throw std::runtime_error("the hit trace could not be opened for writing");
+        }
+        m_file.write(headerData.data(), headerData.size());
+    }
+
+
+    //writes records
+    void HitTrace::write(const std::vector<uint8_t> &records)
+    {
+        if (!m_file.is_open())
+        {
+            return;
+        }
+        m_file.write(reinterpret_cast<const char *>(records.data()), records.size());
+        m_file.flush();
+        if (!m_file.good())
+        {
+            throw std::runtime_error("the hit trace could not be written");
+        }
+    }
+
+
+    //writes the buffered records
+    void HitTrace::flush()
+    {
+        write(m_buffer);
+        m_buffer.clear();
+    }
+
+
+    //closes the file
+    void HitTrace::close()
+    {
+        flush();
+        m_file.close();
+    }
+
+
+} //namespace Lottery
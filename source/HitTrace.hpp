@@ -0,0 +1,118 @@
+#ifndef LOTTERY_HITTRACE_HPP
+#define LOTTERY_HITTRACE_HPP
+
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include "PredictionAlgorithm.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Binary trace of the count of numbers found per test draw.
+
+        The file starts with a header:
+            - magic (uint32), version (uint32);
+            - first test draw index (uint64);
+            - algorithm count (uint64) followed by the algorithm names;
+            - subgame count (uint64) followed by the subgame names and number counts (uint64).
+
+        Then there is one record per test draw, in draw order,
+        with one byte per algorithm/subgame pair (algorithm major):
+        the count of numbers found, or NotComputed if the result
+        was served from the result cache.
+     */
+    class HitTrace
+    {
+    public:
+        ///value recorded for results that were not computed.
+        static constexpr uint8_t NotComputed = 0xff;
+
+        ///writes the remaining records.
+        ~HitTrace()
+        {
+            try
+            {
+                close();
+            }
+            catch (const std::runtime_error &)
+            {
+            }
+        }
+
+        /**
+            Creates the trace file, or continues an existing one.
+            @param filename name of the trace file.
+            @param predictionAlgorithms the algorithms.
+            @param game the game.
+            @param firstDrawIndex index of the first test draw.
+            @param resumeDrawIndex if greater than firstDrawIndex, the existing trace is
+                continued from this draw, discarding any records after it.
+            @exception std::runtime_error if there was an error.
+         */
+        void open(
+            const std::string &filename,
+            const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms,
+            const Game &game,
+            size_t firstDrawIndex,
+            size_t resumeDrawIndex);
+
+        ///returns the size of a record.
+        size_t getRecordSize() const
+        {
+            return m_recordSize;
+        }
+
+        /**
+            Buffers the record of the next test draw.
+            @param hits count of numbers found per algorithm/subgame pair; getRecordSize() bytes.
+         */
+        void record(const uint8_t *hits)
+        {
+            m_buffer.insert(m_buffer.end(), hits, hits + m_recordSize);
+        }
+
+        /**
+            Moves the buffered records out, so that they are written by another thread (see write).
+            @param records receives the records; its previous content is discarded.
+         */
+        void takeRecords(std::vector<uint8_t> &records)
+        {
+            records.clear();
+            records.swap(m_buffer);
+        }
+
+        /**
+            Writes records taken from the buffer to the file, and flushes it.
+            It can be called while another thread records.
+            @param records the records.
+            @exception std::runtime_error if there was an error.
+         */
+        void write(const std::vector<uint8_t> &records);
+
+        /**
+            Writes the buffered records to the file.
+            @exception std::runtime_error if there was an error.
+         */
+        void flush();
+
+        /**
+            Flushes and closes the file.
+         */
+        void close();
+
+    private:
+        std::ofstream m_file;
+        size_t m_recordSize = 0;
+        std::vector<uint8_t> m_buffer;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_HITTRACE_HPP
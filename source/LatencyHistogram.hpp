@@ -0,0 +1,191 @@
+#ifndef LOTTERY_LATENCYHISTOGRAM_HPP
+#define LOTTERY_LATENCYHISTOGRAM_HPP
+
+
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <limits>
+
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    /**
+        Histogram of durations (or any unsigned values) with logarithmic buckets,
+        each power of two split into linear sub-buckets.
+        It covers the full range of uint64_t with a relative error
+        of at most 1/SubBucketCount, at a fixed size and O(1) recording cost.
+     */
+    class LatencyHistogram
+    {
+    public:
+        ///number of bits for sub-buckets.
+        static constexpr unsigned SubBucketBits = 5;
+
+        ///number of sub-buckets per power of two.
+        static constexpr uint64_t SubBucketCount = 1ull << SubBucketBits;
+
+        ///number of buckets.
+        static constexpr size_t BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+        ///records a value.
+        void record(uint64_t value)
+        {
+            ++m_buckets[_getBucketIndex(value)];
+            ++m_count;
+            m_total += value;
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        ///records a value a number of times.
+        void record(uint64_t value, uint64_t count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+            m_buckets[_getBucketIndex(value)] += count;
+            m_count += count;
+            m_total += value * count;
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        ///adds the values of another histogram.
+        void merge(const LatencyHistogram &other)
+        {
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                m_buckets[i] += other.m_buckets[i];
+            }
+            m_count += other.m_count;
+            m_total += other.m_total;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        ///returns the number of recorded values.
+        uint64_t getCount() const
+        {
+            return m_count;
+        }
+
+        ///returns the sum of recorded values.
+        uint64_t getTotal() const
+        {
+            return m_total;
+        }
+
+        ///returns the minimum recorded value, or 0 if there are no values.
+        uint64_t getMin() const
+        {
+            return m_count ? m_min : 0;
+        }
+
+        ///returns the maximum recorded value.
+        uint64_t getMax() const
+        {
+            return m_max;
+        }
+
+        ///returns the mean of the recorded values.
+        double getMean() const
+        {
+            return m_count ? (double)m_total / m_count : 0;
+        }
+
+        /**
+            Returns the value at the given percentile;
+            it is the upper bound of the bucket the percentile falls into,
+            limited to the maximum recorded value.
+            @param percentile percentile, from 0 to 100.
+         */
+        uint64_t getPercentile(double percentile) const
+        {
+            if (m_count == 0)
+            {
+                return 0;
+            }
+
+            const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * m_count;
+            const uint64_t target = std::max<uint64_t>((uint64_t)rank + (rank > (uint64_t)rank ? 1 : 0), 1);
+
+            uint64_t count = 0;
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                count += m_buckets[i];
+                if (count >= target)
+                {
+                    return std::min(_getBucketUpperBound(i), m_max);
+                }
+            }
+
+            return m_max;
+        }
+
+    private:
+        std::array<uint64_t, BucketCount> m_buckets{};
+        uint64_t m_count = 0;
+        uint64_t m_total = 0;
+        uint64_t m_min = std::numeric_limits<uint64_t>::max();
+        uint64_t m_max = 0;
+
+        //returns the index of the highest bit set; the value must not be 0
+        static unsigned _getHighestBit(uint64_t value)
+        {
+            #if defined(__GNUC__) || defined(__clang__)
+            return 63 - (unsigned)__builtin_clzll(value);
+            #elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long result;
+            _BitScanReverse64(&result, value);
+            return (unsigned)result;
+            #else
+            unsigned result = 0;
+            while (value >>= 1)
+            {
+                ++result;
+            }
+            return result;
+            #endif
+        }
+
+        //returns the bucket of a value
+        static size_t _getBucketIndex(uint64_t value)
+        {
+            if (value < SubBucketCount)
+            {
+                return (size_t)value;
+            }
+            const unsigned magnitude = _getHighestBit(value);
+            const uint64_t subBucket = (value >> (magnitude - SubBucketBits)) & (SubBucketCount - 1);
+            return (size_t)((magnitude - SubBucketBits + 1) * SubBucketCount + subBucket);
+        }
+
+        //returns the greatest value of a bucket
+        static uint64_t _getBucketUpperBound(size_t index)
+        {
+            if (index < SubBucketCount)
+            {
+                return index;
+            }
+            const unsigned magnitude = (unsigned)(index / SubBucketCount) + SubBucketBits - 1;
+            const uint64_t subBucket = index % SubBucketCount;
+            const unsigned shift = magnitude - SubBucketBits;
+            const uint64_t lowerBound = (SubBucketCount + subBucket) << shift;
+            return lowerBound + ((1ull << shift) - 1);
+        }
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_LATENCYHISTOGRAM_HPP
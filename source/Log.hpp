@@ -2,6 +2,8 @@
 #define LOTTERY_LOG_HPP
 
 
+#include <string>
+#include <cstdint>
 #include "toString.hpp"
 
 
@@ -9,6 +11,71 @@ namespace Lottery
 {
 
 
+    /**
+        Importance of log messages.
+     */
+    enum class LogLevel
+    {
+        ///details for debugging.
+        Debug,
+
+        ///normal messages.
+        Info,
+
+        ///unexpected situations that do not stop the program.
+        Warning,
+
+        ///errors.
+        Error
+    };
+
+
+    /**
+        Asynchronous logger.
+        Messages are put in a bounded lock-free queue and written to the log file
+        (and optionally to the console) by a background thread, so that logging
+        does not block the calling thread; if the queue is full, the message is dropped
+        and counted.
+        The log file is $LOTTERYPRIVATE/Logs/log.txt.
+     */
+    class Logger
+    {
+    public:
+        /**
+            Tells if messages of the given level are written.
+            It does not start the writer thread, so disabled messages cost only the check.
+         */
+        static bool isEnabled(LogLevel level);
+
+        /**
+            Sets the minimum level of messages to write; the default is LOTTERY_LOG_LEVEL.
+         */
+        static void setLevel(LogLevel level);
+
+        /**
+            Enables or disables writing to the console; it is enabled by default.
+         */
+        static void setConsoleOutput(bool enabled);
+
+        /**
+            Queues a message for writing.
+            @param level level of the message.
+            @param message message.
+         */
+        static void write(LogLevel level, std::string &&message);
+
+        /**
+            Waits until all the messages queued so far are written.
+         */
+        static void flush();
+
+        /**
+            Returns the number of messages dropped because the queue was full.
+         */
+        static uint64_t getDroppedCount();
+    };
+
+
     /**
         Writes the given string to the log.
      */
@@ -20,18 +87,45 @@ namespace Lottery
      */
     template <class ...T> void log(T &&...data)
     {
-        log(toString(data...).c_str());
+        if (Logger::isEnabled(LogLevel::Info))
+        {
+            Logger::write(LogLevel::Info, toString(data...));
+        }
     }
 
 
 } //namespace Lottery
 
 
+///minimum level of log messages that are compiled in; Debug in debug builds, Info otherwise.
+#ifndef LOTTERY_LOG_LEVEL
 #ifndef NDEBUG
-#define LOTTERY_LOG(...) Lottery::log(__VA_ARGS__)
+#define LOTTERY_LOG_LEVEL 0
 #else
-#define LOTTERY_LOG(__VA_ARGS__) 
+#define LOTTERY_LOG_LEVEL 1
+#endif
 #endif
 
 
+///writes to the log at the given level; the arguments are converted to string only if the level is enabled.
+#define LOTTERY_LOG_AT(LEVEL, ...)\
+    do\
+    {\
+        if ((int)(LEVEL) >= LOTTERY_LOG_LEVEL && Lottery::Logger::isEnabled(LEVEL))\
+        {\
+            Lottery::Logger::write(LEVEL, Lottery::toString(__VA_ARGS__));\
+        }\
+    } while (false)
+
+
+#define LOTTERY_LOG_DEBUG(...) LOTTERY_LOG_AT(Lottery::LogLevel::Debug, __VA_ARGS__)
+#define LOTTERY_LOG_INFO(...) LOTTERY_LOG_AT(Lottery::LogLevel::Info, __VA_ARGS__)
+#define LOTTERY_LOG_WARNING(...) LOTTERY_LOG_AT(Lottery::LogLevel::Warning, __VA_ARGS__)
+#define LOTTERY_LOG_ERROR(...) LOTTERY_LOG_AT(Lottery::LogLevel::Error, __VA_ARGS__)
+
+
+///debug log; compiled out in release builds.
+#define LOTTERY_LOG(...) LOTTERY_LOG_DEBUG(__VA_ARGS__)
+
+
 #endif //LOTTERY_LOG_HPP
@@ -0,0 +1,120 @@
+#include "MemoryTracker.hpp"
+#include "Log.hpp"
+
+
+namespace Lottery
+{
+
+
+    //the counters
+    MemoryTracker::Counters MemoryTracker::m_counters[(size_t)MemorySubsystem::Count];
+
+
+    //returns the name of a subsystem
+    const char *MemoryTracker::getName(MemorySubsystem subsystem)
+    {
+        static const char *names[] = { "Game", "Algorithm", "Results", "Enumeration" };
+        return names[(size_t)subsystem];
+    }
+
+
+    //returns the usage of a subsystem
+    MemoryUsage MemoryTracker::getUsage(MemorySubsystem subsystem)
+    {
+        const Counters &counters = m_counters[(size_t)subsystem];
+        MemoryUsage usage;
+        usage.currentBytes = counters.currentBytes.load(std::memory_order_relaxed);
+        usage.peakBytes = counters.peakBytes.load(std::memory_order_relaxed);
+        usage.allocationCount = counters.allocationCount.load(std::memory_order_relaxed);
+        return usage;
+    }
+
+
+    //a memory resource which records its allocations into a subsystem
+    class SubsystemMemoryResource : public std::pmr::memory_resource
+    {
+    public:
+        SubsystemMemoryResource(MemorySubsystem subsystem)
+            : m_subsystem(subsystem)
+        {
+        }
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override
+        {
+            void *result = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+            #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+            MemoryTracker::allocated(m_subsystem, bytes);
+            #endif
+            return result;
+        }
+
+        void do_deallocate(void *ptr, size_t bytes, size_t alignment) override
+        {
+            #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+            MemoryTracker::deallocated(m_subsystem, bytes);
+            #endif
+            std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        MemorySubsystem m_subsystem;
+    };
+
+
+    //returns the memory resource of a subsystem
+    std::pmr::memory_resource *MemoryTracker::getResource(MemorySubsystem subsystem)
+    {
+        static SubsystemMemoryResource resources[] = {
+            SubsystemMemoryResource(MemorySubsystem::Game),
+            SubsystemMemoryResource(MemorySubsystem::Algorithm),
+            SubsystemMemoryResource(MemorySubsystem::Results),
+            SubsystemMemoryResource(MemorySubsystem::Enumeration) };
+        return &resources[(size_t)subsystem];
+    }
+
+
+    //records the difference of the bytes held
+    void MemoryCharge::setBytes(size_t bytes) noexcept
+    {
+        #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+        if (bytes > m_bytes)
+        {
+            MemoryTracker::allocated(m_subsystem, bytes - m_bytes);
+        }
+        else if (bytes < m_bytes)
+        {
+            MemoryTracker::deallocated(m_subsystem, m_bytes - bytes);
+        }
+        #endif
+        m_bytes = bytes;
+    }
+
+
+    //writes the report
+    void MemoryTracker::report()
+    {
+        if (!isEnabled())
+        {
+            log("Memory report: memory tracking is not enabled (define LOTTERY_ENABLE_MEMORY_TRACKING)");
+            return;
+        }
+
+        log("Memory report:");
+        for (size_t i = 0; i < (size_t)MemorySubsystem::Count; ++i)
+        {
+            const MemoryUsage usage = getUsage((MemorySubsystem)i);
+            log("  ", getName((MemorySubsystem)i),
+                ": current=", usage.currentBytes,
+                " peak=", usage.peakBytes,
+                " allocations=", usage.allocationCount);
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,254 @@
+#ifndef LOTTERY_MEMORYTRACKER_HPP
+#define LOTTERY_MEMORYTRACKER_HPP
+
+
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <cstdint>
+#include <cstddef>
+#include "AlignedAllocator.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Subsystems whose memory is tracked.
+     */
+    enum class MemorySubsystem
+    {
+        ///game and subgame data: draws and draw columns.
+        Game,
+
+        ///state and output of prediction algorithms.
+        Algorithm,
+
+        ///backtest results.
+        Results,
+
+        ///enumeration buffers (rows, permutations).
+        Enumeration,
+
+        ///number of subsystems.
+        Count
+    };
+
+
+    /**
+        Memory usage of a subsystem.
+     */
+    struct MemoryUsage
+    {
+        ///bytes currently allocated.
+        uint64_t currentBytes = 0;
+
+        ///maximum of bytes allocated at any time.
+        uint64_t peakBytes = 0;
+
+        ///number of allocations made.
+        uint64_t allocationCount = 0;
+    };
+
+
+    /**
+        Per-subsystem memory counters, updated by TrackingAllocator.
+        Tracking is compiled in only if LOTTERY_ENABLE_MEMORY_TRACKING is defined;
+        otherwise the subsystems use the standard allocator and all usages are 0.
+     */
+    class MemoryTracker
+    {
+    public:
+        ///tells if memory tracking is compiled in.
+        static constexpr bool isEnabled()
+        {
+            #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+            return true;
+            #else
+            return false;
+            #endif
+        }
+
+        ///returns the name of a subsystem.
+        static const char *getName(MemorySubsystem subsystem);
+
+        ///records an allocation.
+        static void allocated(MemorySubsystem subsystem, size_t bytes)
+        {
+            Counters &counters = m_counters[(size_t)subsystem];
+            const uint64_t current = counters.currentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+            counters.allocationCount.fetch_add(1, std::memory_order_relaxed);
+            uint64_t peak = counters.peakBytes.load(std::memory_order_relaxed);
+            while (current > peak && !counters.peakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        ///records a deallocation.
+        static void deallocated(MemorySubsystem subsystem, size_t bytes)
+        {
+            m_counters[(size_t)subsystem].currentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        ///returns the memory usage of a subsystem.
+        static MemoryUsage getUsage(MemorySubsystem subsystem);
+
+        /**
+            Returns a memory resource which allocates from the heap
+            and records its allocations in the counters of a subsystem.
+            Unlike SubsystemAllocator, its type does not depend on LOTTERY_ENABLE_MEMORY_TRACKING.
+         */
+        static std::pmr::memory_resource *getResource(MemorySubsystem subsystem);
+
+        /**
+            Writes the memory usage of all subsystems to the log.
+            It can be called at any time.
+         */
+        static void report();
+
+    private:
+        struct alignas(CacheLineSize) Counters
+        {
+            std::atomic<uint64_t> currentBytes{ 0 };
+            std::atomic<uint64_t> peakBytes{ 0 };
+            std::atomic<uint64_t> allocationCount{ 0 };
+        };
+
+        static Counters m_counters[(size_t)MemorySubsystem::Count];
+    };
+
+
+    /**
+        Allocator which records its allocations in the counters of a subsystem,
+        and delegates the allocation to another allocator.
+        @param T value type.
+        @param Subsystem subsystem to record allocations into.
+        @param Base allocator to allocate memory with.
+     */
+    template <class T, MemorySubsystem Subsystem, class Base = std::allocator<T>> class TrackingAllocator : public Base
+    {
+    public:
+        ///value type.
+        typedef T value_type;
+
+        ///rebinds the allocator to another type.
+        template <class U> struct rebind
+        {
+            typedef TrackingAllocator<U, Subsystem, typename std::allocator_traits<Base>::template rebind_alloc<U>> other;
+        };
+
+        ///the default constructor.
+        TrackingAllocator() noexcept
+        {
+        }
+
+        ///copy constructor from allocator of other type.
+        template <class U, class OtherBase> TrackingAllocator(const TrackingAllocator<U, Subsystem, OtherBase> &other) noexcept
+            : Base(static_cast<const OtherBase &>(other))
+        {
+        }
+
+        ///allocates memory for the given count of objects.
+        T *allocate(size_t count)
+        {
+            T *result = Base::allocate(count);
+            MemoryTracker::allocated(Subsystem, count * sizeof(T));
+            return result;
+        }
+
+        ///frees memory.
+        void deallocate(T *ptr, size_t count) noexcept
+        {
+            MemoryTracker::deallocated(Subsystem, count * sizeof(T));
+            Base::deallocate(ptr, count);
+        }
+
+        ///compares the base allocators.
+        template <class U, class OtherBase> bool operator == (const TrackingAllocator<U, Subsystem, OtherBase> &other) const noexcept
+        {
+            return static_cast<const Base &>(*this) == static_cast<const OtherBase &>(other);
+        }
+
+        ///compares the base allocators.
+        template <class U, class OtherBase> bool operator != (const TrackingAllocator<U, Subsystem, OtherBase> &other) const noexcept
+        {
+            return !(*this == other);
+        }
+    };
+
+
+    /**
+        Bytes held in containers whose types must not depend on LOTTERY_ENABLE_MEMORY_TRACKING,
+        i.e. the draws passed to the algorithms; the owner sets them whenever the containers grow or shrink,
+        and they are recorded in the counters of a subsystem until the charge is destroyed.
+     */
+    class MemoryCharge
+    {
+    public:
+        ///constructor.
+        MemoryCharge(MemorySubsystem subsystem)
+            : m_subsystem(subsystem)
+        {
+        }
+
+        MemoryCharge(const MemoryCharge &) = delete;
+        MemoryCharge &operator = (const MemoryCharge &) = delete;
+
+        ///move constructor; the bytes are moved with the containers.
+        MemoryCharge(MemoryCharge &&other) noexcept
+            : m_subsystem(other.m_subsystem)
+            , m_bytes(other.m_bytes)
+        {
+            other.m_bytes = 0;
+        }
+
+        ///move assignment; the bytes are moved with the containers.
+        MemoryCharge &operator = (MemoryCharge &&other) noexcept
+        {
+            if (this != &other)
+            {
+                setBytes(0);
+                m_subsystem = other.m_subsystem;
+                m_bytes = other.m_bytes;
+                other.m_bytes = 0;
+            }
+            return *this;
+        }
+
+        ///releases the bytes.
+        ~MemoryCharge()
+        {
+            setBytes(0);
+        }
+
+        ///returns the bytes charged.
+        size_t getBytes() const
+        {
+            return m_bytes;
+        }
+
+        ///sets the bytes held, recording the difference.
+        void setBytes(size_t bytes) noexcept;
+
+    private:
+        MemorySubsystem m_subsystem;
+        size_t m_bytes = 0;
+    };
+
+
+    /**
+        The allocator of a subsystem: a TrackingAllocator if memory tracking is enabled,
+        the base allocator otherwise.
+     */
+    #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+    template <class T, MemorySubsystem Subsystem, class Base = std::allocator<T>> using SubsystemAllocator = TrackingAllocator<T, Subsystem, Base>;
+    #else
+    template <class T, MemorySubsystem Subsystem, class Base = std::allocator<T>> using SubsystemAllocator = Base;
+    #endif
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_MEMORYTRACKER_HPP
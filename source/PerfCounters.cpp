@@ -0,0 +1,146 @@
+#include <cstdlib>
+#include <cstring>
+#include "PerfCounters.hpp"
+
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    //enabled from the environment
+    static bool _isEnabledFromEnvironment()
+    {
+        const char *value = std::getenv("LOTTERY_PERF_COUNTERS");
+        return value && std::strcmp(value, "1") == 0;
+    }
+
+
+    std::atomic<bool> PerfCounters::m_enabled{ _isEnabledFromEnvironment() };
+
+
+#ifdef __linux__
+
+
+    //the counters of a thread
+    class PerfCounterGroup
+    {
+    public:
+        //opens the counters of the current thread as a group, so that they are read with one call
+        PerfCounterGroup()
+        {
+            static const std::pair<uint32_t, uint64_t> events[(size_t)PerfCounter::Count] =
+            {
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+            };
+
+            for (size_t i = 0; i < (size_t)PerfCounter::Count; ++i)
+            {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = events[i].first;
+                attr.config = events[i].second;
+                attr.disabled = m_leader == -1 ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                const int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0);
+                if (fd == -1)
+                {
+                    //without cycles, nothing is counted
+                    if (i == 0)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+
+                if (m_leader == -1)
+                {
+                    m_leader = fd;
+                }
+                m_fds[m_count] = fd;
+                m_counters[m_count] = i;
+                ++m_count;
+            }
+
+            ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+
+        //closes the counters
+        ~PerfCounterGroup()
+        {
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                close(m_fds[i]);
+            }
+        }
+
+        //reads the counters
+        bool read(PerfCounterValues &values) const
+        {
+            if (m_leader == -1)
+            {
+                return false;
+            }
+
+            //the group format is the number of counters, the times enabled and running, then the values
+            uint64_t buffer[3 + (size_t)PerfCounter::Count];
+            if (::read(m_leader, buffer, sizeof(buffer)) < (ssize_t)((3 + m_count) * sizeof(uint64_t)))
+            {
+                return false;
+            }
+
+            values.timeEnabled = buffer[1];
+            values.timeRunning = buffer[2];
+            for (size_t i = 0; i < m_count; ++i)
+            {
+                values.values[m_counters[i]] = buffer[3 + i];
+            }
+            return true;
+        }
+
+    private:
+        int m_leader = -1;
+        int m_fds[(size_t)PerfCounter::Count];
+        size_t m_counters[(size_t)PerfCounter::Count];
+        size_t m_count = 0;
+    };
+
+
+    //reads the counters of the current thread
+    bool PerfCounters::read(PerfCounterValues &values)
+    {
+        static thread_local PerfCounterGroup group;
+        return group.read(values);
+    }
+
+
+#else
+
+
+    //counters are not supported
+    bool PerfCounters::read(PerfCounterValues &)
+    {
+        return false;
+    }
+
+
+#endif
+
+
+} //namespace Lottery
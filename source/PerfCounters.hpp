@@ -0,0 +1,141 @@
+#ifndef LOTTERY_PERFCOUNTERS_HPP
+#define LOTTERY_PERFCOUNTERS_HPP
+
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Hardware events counted per thread.
+     */
+    enum class PerfCounter
+    {
+        ///cpu cycles.
+        Cycles,
+
+        ///retired instructions.
+        Instructions,
+
+        ///level 1 data cache read misses.
+        L1DataMisses,
+
+        ///last level cache misses.
+        LastLevelCacheMisses,
+
+        ///mispredicted branches.
+        BranchMisses,
+
+        ///number of counters.
+        Count
+    };
+
+
+    /**
+        Values of the hardware counters.
+     */
+    struct PerfCounterValues
+    {
+        ///values, indexed by PerfCounter.
+        std::array<uint64_t, (size_t)PerfCounter::Count> values{};
+
+        ///nanoseconds the counters were enabled.
+        uint64_t timeEnabled = 0;
+
+        ///nanoseconds the counters were counting; less than enabled while the kernel multiplexed them out.
+        uint64_t timeRunning = 0;
+
+        ///returns the value of a counter.
+        uint64_t operator [](PerfCounter counter) const
+        {
+            return values[(size_t)counter];
+        }
+
+        /**
+            Adds the difference end - start, scaled by the time enabled over the time running,
+            so that the counts estimate the whole interval when the counters were multiplexed.
+            @return false if the counters did not run between start and end; nothing is added then.
+         */
+        bool addDifference(const PerfCounterValues &start, const PerfCounterValues &end)
+        {
+            const uint64_t running = end.timeRunning - start.timeRunning;
+            if (running == 0)
+            {
+                return false;
+            }
+            const uint64_t enabled = end.timeEnabled - start.timeEnabled;
+            const double scale = (double)enabled / running;
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                values[i] += (uint64_t)((end.values[i] - start.values[i]) * scale + 0.5);
+            }
+            timeEnabled += enabled;
+            timeRunning += running;
+            return true;
+        }
+
+        ///adds other values.
+        PerfCounterValues &operator += (const PerfCounterValues &other)
+        {
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                values[i] += other.values[i];
+            }
+            timeEnabled += other.timeEnabled;
+            timeRunning += other.timeRunning;
+            return *this;
+        }
+    };
+
+
+    /**
+        Hardware performance counters of the current thread,
+        read through perf_event_open on Linux.
+
+        Counting is enabled by setting the environment variable LOTTERY_PERF_COUNTERS to 1.
+        Where the counters are unavailable (other systems, containers without perf access,
+        virtual machines without a PMU), reading fails and profiling falls back to time only.
+        When more events are requested than the PMU has counters, the kernel multiplexes them,
+        and the counts are scaled by the fraction of the time they were counting.
+     */
+    class PerfCounters
+    {
+    public:
+        ///tells if reading the counters is enabled.
+        static bool isEnabled()
+        {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        ///enables or disables reading the counters.
+        static void setEnabled(bool enabled)
+        {
+            m_enabled = enabled;
+        }
+
+        /**
+            Reads the counters of the current thread.
+            The counters are opened on the first call of each thread.
+            Counters that are not supported by the hardware remain 0.
+            The values are raw counts, with the times the group was enabled and running;
+            PerfCounterValues::addDifference scales them.
+            @param values the result.
+            @return true if the counters could be read, false otherwise.
+         */
+        static bool read(PerfCounterValues &values);
+
+    private:
+        static std::atomic<bool> m_enabled;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_PERFCOUNTERS_HPP
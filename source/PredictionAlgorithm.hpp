@@ -2,7 +2,10 @@
 #define LOTTERY_PREDICTIONALGORITHM_HPP
 
 
+#include <memory_resource>
 #include <unordered_set>
+#include <istream>
+#include <ostream>
 #include <string>
 #include "Game.hpp"
 
@@ -16,15 +19,35 @@ namespace Lottery
      */
     struct Prediction
     {
+        ///set of predicted numbers.
+        typedef std::pmr::unordered_set<Number> Numbers;
+
+        /**
+            Constructor.
+            @param arena memory for the numbers and the temporary data of the algorithm.
+         */
+        Prediction(std::pmr::memory_resource *arena = std::pmr::get_default_resource())
+            : arena(arena)
+            , numbers(arena)
+        {
+        }
+
         /**
             Count of numbers requested to be predicted.
          */
-        size_t count;
+        size_t count = 0;
+
+        /**
+            Memory for temporary data of the algorithm, i.e. std::pmr containers.
+            In a backtest, it is an arena shared by the predictions of a batch of draws,
+            released when the next batch is predicted, so the algorithm must not keep anything allocated from it.
+         */
+        std::pmr::memory_resource *arena;
 
         /**
             Predicted numbers.
          */
-        std::unordered_set<Number> numbers;
+        Numbers numbers;
     };
 
 
@@ -44,6 +67,45 @@ namespace Lottery
          */
         virtual std::string getName() const = 0;
 
+        /**
+            Returns the algorithm's version.
+            It must change whenever the algorithm's results change,
+            so that cached results are not reused.
+         */
+        virtual std::string getVersion() const
+        {
+            return "1";
+        }
+
+        /**
+            Returns the algorithm's parameters as text.
+            Algorithms with parameters that affect the results
+            must return them, so that cached results are not reused.
+         */
+        virtual std::string getParameters() const
+        {
+            return std::string();
+        }
+
+        /**
+            Tells if the results are reproducible, i.e. the same for the same draws.
+            The results of algorithms which are not are never cached.
+         */
+        virtual bool isDeterministic() const
+        {
+            return true;
+        }
+
+        /**
+            Tells if the algorithm reads the draws passed to it.
+            Algorithms which do not are passed empty ranges by the backtest,
+            so that the rows of subgames loaded by column are not built for them.
+         */
+        virtual bool readsDraws() const
+        {
+            return true;
+        }
+
         /**
             Interface for initializing the prediction model.
             @param subGame the sub-game for which the sample draws are about.
@@ -55,16 +117,80 @@ namespace Lottery
             Interface for doing the prediction.
             @param subGame the sub-game for which the sample draws are about.
             @param previousDraws previous draws.
-            @param prediction prediction.
+            @param prediction prediction; temporary data can be allocated from its arena.
          */
         virtual void predict(const SubGame &subGame, const DrawVectorRange &previousDraws, Prediction &prediction) = 0;
 
+        /**
+            Interface for predicting consecutive draws of a subgame in one call,
+            so that algorithms can set up once and compute across draws, i.e. with SIMD.
+            Each draw is predicted from the draws before it, as if predict was called for each draw in order.
+            The backtest prefers it over predict; it may predict several draws of a subgame
+            before the other subgames, so the predictions of a subgame must not depend
+            on the order in which subgames are predicted.
+            The default calls predict for each draw; the rows of a subgame loaded by column are built for it.
+            @param subGame the sub-game for which the draws are about.
+            @param beginDrawIndex index of the first draw to predict.
+            @param endDrawIndex index of the draw after the last draw to predict.
+            @param predictions one prediction per draw; temporary data can be allocated from their arena.
+         */
+        virtual void predictBatch(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, Prediction *predictions)
+        {
+            const DrawVector &draws = subGame.getDraws();
+            for (size_t drawIndex = beginDrawIndex; drawIndex < endDrawIndex; ++drawIndex)
+            {
+                predict(subGame, DrawVectorRange(draws.begin(), draws.begin() + drawIndex), predictions[drawIndex - beginDrawIndex]);
+            }
+        }
+
+        /**
+            Interface for updating the prediction model with draws appended to the subgame
+            after initialize, i.e. when the draws file is followed.
+            The default does nothing, since the previous draws are passed to predict anyway.
+            The subgame belongs to a new version of the game; algorithms must not keep
+            references to the subgames or draws passed in earlier calls.
+            @param subGame the sub-game for which the draws are about.
+            @param newDraws the appended draws.
+         */
+        virtual void update(const SubGame &/*subGame*/, const DrawVectorRange &/*newDraws*/)
+        {
+        }
+
         /**
             Interface for finalizing the algorithm.
             @param subGame the sub-game for which the sample draws are about.
             @param sampleDraws sample draws to initialize the prediction model from.
          */
         virtual void finalize(const SubGame &subGame, const DrawVectorRange &sampleDraws) = 0;
+
+        /**
+            Saves the algorithm's model into a checkpoint.
+            Algorithms with state that cannot be recreated by
+            initialize (i.e. random engines) should override this.
+            @param stream binary stream to write the state to.
+         */
+        virtual void saveState(std::ostream &/*stream*/) const
+        {
+        }
+
+        /**
+            Restores the algorithm's model from a checkpoint.
+            It is called after initialize.
+            @param stream binary stream to read the state from.
+         */
+        virtual void loadState(std::istream &/*stream*/)
+        {
+        }
+
+    protected:
+        /**
+            Returns the memory for the model state of algorithms, i.e. for std::pmr containers.
+            It is recorded in the Algorithm subsystem of the memory tracker, if tracking is compiled in.
+         */
+        static std::pmr::memory_resource *getStateMemory()
+        {
+            return MemoryTracker::getResource(MemorySubsystem::Algorithm);
+        }
     };
 
 
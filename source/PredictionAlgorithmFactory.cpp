@@ -0,0 +1,94 @@
+#include <algorithm>
+#include "PredictionAlgorithmFactory.hpp"
+#include "RandomPredictionAlgorithm.hpp"
+#include "PredictionAlgorithmA.hpp"
+#include "parseNumber.hpp"
+
+
+namespace Lottery
+{
+
+
+    //parses the parameters of an algorithm spec
+    static PredictionAlgorithmParameters _parseParameters(const std::string &spec, size_t begin, size_t end)
+    {
+        PredictionAlgorithmParameters parameters;
+        while (begin < end)
+        {
+            size_t separator = spec.find(';', begin);
+            if (separator == std::string::npos || separator > end)
+            {
+                separator = end;
+            }
+            const std::string parameter = spec.substr(begin, separator - begin);
+            const size_t equals = parameter.find('=');
+            if (equals == std::string::npos || equals == 0)
+            {
+                throw std::runtime_error("invalid prediction algorithm parameter: " + parameter);
+            }
+            parameters[parameter.substr(0, equals)] = parameter.substr(equals + 1);
+            begin = separator + 1;
+        }
+        return parameters;
+    }
+
+
+    //throws an exception if there are parameters not used by the algorithm
+    static void _checkParameters(const std::string &name, const PredictionAlgorithmParameters &parameters, std::initializer_list<const char *> known)
+    {
+        for (const auto &parameter : parameters)
+        {
+            if (std::find_if(known.begin(), known.end(), [&](const char *k) { return parameter.first == k; }) == known.end())
+            {
+                throw std::runtime_error("unknown parameter of prediction algorithm " + name + ": " + parameter.first);
+            }
+        }
+    }
+
+
+    //returns the names of the algorithms
+    std::vector<std::string> getPredictionAlgorithmNames()
+    {
+        return { "Random", "A" };
+    }
+
+
+    //creates an algorithm
+    std::unique_ptr<PredictionAlgorithm> createPredictionAlgorithm(const std::string &spec, const Game &game)
+    {
+        //split the name from the parameters
+        std::string name = spec;
+        PredictionAlgorithmParameters parameters;
+        const size_t open = spec.find('(');
+        if (open != std::string::npos)
+        {
+            if (spec.back() != ')')
+            {
+                throw std::runtime_error("invalid prediction algorithm: " + spec);
+            }
+            name = spec.substr(0, open);
+            parameters = _parseParameters(spec, open + 1, spec.size() - 1);
+        }
+
+        if (name == "Random")
+        {
+            _checkParameters(name, parameters, { "seed" });
+            const auto seed = parameters.find("seed");
+            if (seed != parameters.end())
+            {
+                return std::make_unique<RandomPredictionAlgorithm>(game, parseNumber(seed->second, "seed"));
+            }
+            return std::make_unique<RandomPredictionAlgorithm>(game);
+        }
+
+        if (name == "A")
+        {
+            _checkParameters(name, parameters, {});
+            return std::make_unique<PredictionAlgorithmA>(game);
+        }
+
+        throw std::runtime_error("unknown prediction algorithm: " + name);
+    }
+
+
+} //namespace Lottery
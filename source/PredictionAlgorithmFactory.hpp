@@ -0,0 +1,43 @@
+#ifndef LOTTERY_PREDICTIONALGORITHMFACTORY_HPP
+#define LOTTERY_PREDICTIONALGORITHMFACTORY_HPP
+
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <map>
+#include "PredictionAlgorithm.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Returns the names of the algorithms that can be created by name.
+     */
+    std::vector<std::string> getPredictionAlgorithmNames();
+
+
+    /**
+        Parameters of an algorithm, by name.
+     */
+    typedef std::map<std::string, std::string> PredictionAlgorithmParameters;
+
+
+    /**
+        Creates a prediction algorithm by name.
+        @param spec name of the algorithm, as returned by PredictionAlgorithm::getName(),
+            optionally followed by parameters in parentheses, separated by semicolons,
+            i.e. "Random(seed=5)".
+        @param game the game the algorithm is for.
+        @exception std::runtime_error if there is no algorithm with the given name
+            or the parameters are invalid.
+     */
+    std::unique_ptr<PredictionAlgorithm> createPredictionAlgorithm(const std::string &spec, const Game &game);
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_PREDICTIONALGORITHMFACTORY_HPP
@@ -0,0 +1,474 @@
+#include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "PredictionServer.hpp"
+#include "Profile.hpp"
+
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/epoll.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    //maximum size of a request line
+    static constexpr size_t MaxLineSize = 1 << 16;
+
+
+    //maximum number of events per iteration of the loop
+    static constexpr size_t MaxEventCount = 256;
+
+
+    //formats a duration in nanoseconds as microseconds
+    static std::string _toMicroseconds(uint64_t duration)
+    {
+        std::ostringstream stream;
+        stream.setf(std::ios_base::fixed);
+        stream.precision(3);
+        stream << duration / 1000.0;
+        return stream.str();
+    }
+
+
+    //constructor
+    PredictionServer::PredictionServer(const Game &game, const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms)
+        : m_game(game)
+        , m_predictionAlgorithms(predictionAlgorithms)
+        , m_tickets(game.getSubGames().size())
+        , m_ticketRequests(game.getSubGames().size())
+    {
+        for (const SubGame &subGame : m_game.getSubGames())
+        {
+            for (const auto &algo : m_predictionAlgorithms)
+            {
+                algo->initialize(subGame, subGame.getDraws());
+            }
+            m_scorers.emplace_back(subGame);
+        }
+    }
+
+
+    //listens on a Unix domain socket
+    void PredictionServer::listenUnix(const std::string &path)
+    {
+        m_listeners.push_back(Socket::listenUnix(path));
+    }
+
+
+    //listens on a TCP port
+    uint16_t PredictionServer::listenTcp(uint16_t port)
+    {
+        m_listeners.push_back(Socket::listenTcp(port));
+        return m_listeners.back().getPort();
+    }
+
+
+#ifdef __linux__
+
+
+    //serves requests
+    void PredictionServer::run(const std::atomic<bool> &stop)
+    {
+        m_pollHandle = epoll_create1(EPOLL_CLOEXEC);
+        if (m_pollHandle < 0)
+        {
+            throw std::runtime_error(std::string("epoll_create1 failed: ") + std::strerror(errno));
+        }
+
+        for (Socket &listener : m_listeners)
+        {
+            listener.setNonBlocking();
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = listener.getHandle();
+            epoll_ctl(m_pollHandle, EPOLL_CTL_ADD, listener.getHandle(), &event);
+        }
+
+        epoll_event events[MaxEventCount];
+        while (!stop)
+        {
+            const int eventCount = epoll_wait(m_pollHandle, events, (int)MaxEventCount, 100);
+            if (eventCount < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+            }
+
+            const uint64_t startTime = Profiler::now();
+            for (int i = 0; i < eventCount; ++i)
+            {
+                const int handle = events[i].data.fd;
+
+                //accept the new connections
+                auto listener = std::find_if(m_listeners.begin(), m_listeners.end(), [&](const Socket &socket) { return socket.getHandle() == handle; });
+                if (listener != m_listeners.end())
+                {
+                    for (Socket socket = listener->accept(); socket.isValid(); socket = listener->accept())
+                    {
+                        socket.setNonBlocking();
+                        socket.setNoDelay();
+                        epoll_event event{};
+                        event.events = EPOLLIN;
+                        event.data.fd = socket.getHandle();
+                        epoll_ctl(m_pollHandle, EPOLL_CTL_ADD, socket.getHandle(), &event);
+                        auto connection = std::make_unique<Connection>();
+                        connection->socket = std::move(socket);
+                        m_connections[event.data.fd] = std::move(connection);
+                    }
+                    continue;
+                }
+
+                auto it = m_connections.find(handle);
+                if (it == m_connections.end() || it->second->closed)
+                {
+                    continue;
+                }
+                Connection &connection = *it->second;
+
+                //read the requests; the connection is closed after the batch
+                if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !connection.inputClosed)
+                {
+                    if (!_read(connection, startTime))
+                    {
+                        connection.closed = true;
+                        continue;
+                    }
+
+                    //the peer finished sending; only the responses are left to write
+                    if (connection.inputClosed)
+                    {
+                        _watch(connection);
+                    }
+                }
+
+                //write the rest of the responses
+                if (((events[i].events & EPOLLOUT) || (connection.inputClosed && (events[i].events & (EPOLLHUP | EPOLLERR)))) && !_write(connection))
+                {
+                    connection.closed = true;
+                }
+            }
+
+            _serveBatch();
+
+            //close the connections closed during the iteration, and those with all their responses written
+            for (auto it = m_connections.begin(); it != m_connections.end();)
+            {
+                if (it->second->closed || (it->second->inputClosed && it->second->output.empty()))
+                {
+                    it = m_connections.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+        m_connections.clear();
+        close(m_pollHandle);
+        m_pollHandle = -1;
+    }
+
+
+    //writes the pending output
+    bool PredictionServer::_write(Connection &connection)
+    {
+        size_t written = 0;
+        bool blocked = false;
+        try
+        {
+            while (written < connection.output.size())
+            {
+                const ptrdiff_t size = connection.socket.write(connection.output.data() + written, connection.output.size() - written);
+                if (size == Socket::WouldBlock)
+                {
+                    blocked = true;
+                    break;
+                }
+                written += (size_t)size;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+            return false;
+        }
+        connection.output.erase(0, written);
+
+        //wait for the connection to be writable, while there is output left
+        if (blocked != connection.writing)
+        {
+            connection.writing = blocked;
+            _watch(connection);
+        }
+
+        return true;
+    }
+
+
+    //sets the events waited for on a connection
+    void PredictionServer::_watch(Connection &connection)
+    {
+        epoll_event event{};
+        event.events = (connection.inputClosed ? 0u : (uint32_t)EPOLLIN) | (connection.writing ? (uint32_t)EPOLLOUT : 0u);
+        event.data.fd = connection.socket.getHandle();
+        epoll_ctl(m_pollHandle, EPOLL_CTL_MOD, connection.socket.getHandle(), &event);
+    }
+
+
+#else
+
+
+    //serves requests
+    void PredictionServer::run(const std::atomic<bool> &stop)
+    {
+        throw std::runtime_error("the prediction server is not supported on this platform");
+    }
+
+
+    //writes the pending output
+    bool PredictionServer::_write(Connection &connection)
+    {
+        return false;
+    }
+
+
+    //sets the events waited for on a connection
+    void PredictionServer::_watch(Connection &connection)
+    {
+    }
+
+
+#endif
+
+
+    //reads the requests of a connection
+    bool PredictionServer::_read(Connection &connection, uint64_t startTime)
+    {
+        char buffer[16384];
+        for (;;)
+        {
+            ptrdiff_t size;
+            try
+            {
+                size = connection.socket.read(buffer, sizeof(buffer));
+            }
+            catch (const std::runtime_error &)
+            {
+                return false;
+            }
+
+            if (size == Socket::WouldBlock)
+            {
+                break;
+            }
+            //the peer finished sending; the complete lines read are still served
+            if (size == 0)
+            {
+                connection.inputClosed = true;
+                break;
+            }
+            connection.input.append(buffer, (size_t)size);
+        }
+
+        //parse the complete lines
+        size_t begin = 0;
+        for (size_t end = connection.input.find('\n'); end != std::string::npos; end = connection.input.find('\n', begin))
+        {
+            _parse(connection, connection.input.substr(begin, end - begin), startTime);
+            begin = end + 1;
+        }
+        connection.input.erase(0, begin);
+
+        return connection.input.size() <= MaxLineSize;
+    }
+
+
+    //parses a request
+    void PredictionServer::_parse(Connection &connection, const std::string &line, uint64_t startTime)
+    {
+        std::istringstream stream(line);
+        std::string command;
+        if (!(stream >> command))
+        {
+            return;
+        }
+
+        m_requests.push_back(Request{ &connection, startTime, std::string() });
+        std::string &response = m_requests.back().response;
+
+        //predict the next draw
+        if (command == "PREDICT")
+        {
+            std::string algorithmName, subGameName;
+            stream >> algorithmName >> subGameName;
+            auto algo = std::find_if(m_predictionAlgorithms.begin(), m_predictionAlgorithms.end(), [&](const auto &algo) { return algo->getName() == algorithmName; });
+            const size_t subGameIndex = _findSubGame(subGameName);
+            if (algo == m_predictionAlgorithms.end())
+            {
+                response = "ERR unknown algorithm " + algorithmName;
+            }
+            else if (subGameIndex == SIZE_MAX)
+            {
+                response = "ERR unknown subgame " + subGameName;
+            }
+            else
+            {
+                const SubGame &subGame = m_game.getSubGames()[subGameIndex];
+                Prediction prediction;
+                prediction.count = subGame.getNumberCount() * 2;
+                (*algo)->predict(subGame, subGame.getDraws(), prediction);
+                std::vector<Number> numbers(prediction.numbers.begin(), prediction.numbers.end());
+                std::sort(numbers.begin(), numbers.end());
+                response = "OK";
+                for (const Number number : numbers)
+                {
+                    response += ' ' + std::to_string(number);
+                }
+            }
+        }
+
+        //queue a ticket for scoring with the batch
+        else if (command == "SCORE")
+        {
+            std::string subGameName;
+            stream >> subGameName;
+            const size_t subGameIndex = _findSubGame(subGameName);
+            if (subGameIndex == SIZE_MAX)
+            {
+                response = "ERR unknown subgame " + subGameName;
+                return;
+            }
+
+            const SubGame &subGame = m_game.getSubGames()[subGameIndex];
+            std::vector<size_t> numbers;
+            for (size_t number; stream >> number;)
+            {
+                if (number < subGame.getMinNumber() || number > subGame.getMaxNumber())
+                {
+                    response = "ERR invalid number " + std::to_string(number);
+                    return;
+                }
+                numbers.push_back(number);
+            }
+            if (!stream.eof() || numbers.empty())
+            {
+                response = "ERR invalid ticket";
+                return;
+            }
+
+            m_tickets[subGameIndex].push_back(TicketScorer::createMask(numbers.begin(), numbers.end()));
+            m_ticketRequests[subGameIndex].push_back(m_requests.size() - 1);
+        }
+
+        //describe the game
+        else if (command == "INFO")
+        {
+            response = "OK " + std::to_string(m_game.getDrawsCount());
+            for (const SubGame &subGame : m_game.getSubGames())
+            {
+                response += ' ' + subGame.getName() + ':' + std::to_string(subGame.getNumberCount()) + ':' +
+                    std::to_string(subGame.getMinNumber()) + '-' + std::to_string(subGame.getMaxNumber());
+            }
+        }
+
+        //describe the durations of the requests
+        else if (command == "STATS")
+        {
+            response = "OK " + std::to_string(m_latencies.getCount()) +
+                ' ' + _toMicroseconds(m_latencies.getPercentile(50)) +
+                ' ' + _toMicroseconds(m_latencies.getPercentile(99)) +
+                ' ' + _toMicroseconds(m_latencies.getPercentile(99.9)) +
+                ' ' + _toMicroseconds(m_latencies.getMax());
+        }
+
+        else
+        {
+            response = "ERR unknown request " + command;
+        }
+    }
+
+
+    //serves the batch of requests
+    void PredictionServer::_serveBatch()
+    {
+        if (m_requests.empty())
+        {
+            return;
+        }
+
+        //score the tickets of each subgame together
+        for (size_t subGameIndex = 0; subGameIndex < m_scorers.size(); ++subGameIndex)
+        {
+            const std::vector<NumberMask> &tickets = m_tickets[subGameIndex];
+            if (tickets.empty())
+            {
+                continue;
+            }
+
+            const TicketScorer &scorer = m_scorers[subGameIndex];
+            const size_t resultSize = scorer.getResultSize();
+            m_scores.resize(tickets.size() * resultSize);
+            scorer.score(tickets.data(), tickets.size(), m_scores.data());
+
+            for (size_t i = 0; i < tickets.size(); ++i)
+            {
+                std::string &response = m_requests[m_ticketRequests[subGameIndex][i]].response;
+                response = "OK";
+                for (size_t j = 0; j < resultSize; ++j)
+                {
+                    response += ' ' + std::to_string(m_scores[i * resultSize + j]);
+                }
+            }
+
+            m_tickets[subGameIndex].clear();
+            m_ticketRequests[subGameIndex].clear();
+        }
+
+        //queue the responses in the order of the requests
+        for (Request &request : m_requests)
+        {
+            if (!request.connection->closed)
+            {
+                request.connection->output += request.response;
+                request.connection->output += '\n';
+            }
+        }
+
+        //send the responses
+        for (Request &request : m_requests)
+        {
+            Connection &connection = *request.connection;
+            if (!connection.closed && !connection.output.empty() && !_write(connection))
+            {
+                connection.closed = true;
+            }
+            m_latencies.record(Profiler::now() - request.startTime);
+        }
+
+        m_requests.clear();
+    }
+
+
+    //finds a subgame
+    size_t PredictionServer::_findSubGame(const std::string &name) const
+    {
+        for (size_t i = 0; i < m_game.getSubGames().size(); ++i)
+        {
+            if (m_game.getSubGames()[i].getName() == name)
+            {
+                return i;
+            }
+        }
+        return SIZE_MAX;
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,135 @@
+#ifndef LOTTERY_PREDICTIONSERVER_HPP
+#define LOTTERY_PREDICTIONSERVER_HPP
+
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "PredictionAlgorithm.hpp"
+#include "TicketScorer.hpp"
+#include "LatencyHistogram.hpp"
+#include "Socket.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Serves predictions and ticket scores for a game,
+        keeping the game and the initialized algorithms in memory.
+
+        Requests and responses are lines of text, with values separated by spaces:
+            - PREDICT <algorithm> <subgame>: predicts the next draw;
+              the response is OK followed by the predicted numbers.
+            - SCORE <subgame> <numbers>: scores a ticket against the draws;
+              the response is OK followed by the count of draws which contain
+              0, 1, ... up to the number count of the subgame numbers of the ticket.
+            - INFO: the response is OK followed by the count of draws
+              and the subgames as <name>:<number count>:<min number>-<max number>.
+            - STATS: the response is OK followed by the count of requests served
+              and the p50, p99, p99.9 and max durations of the requests, in microseconds.
+        Errors are reported as ERR followed by a message.
+        Connections may send requests without waiting for the responses;
+        the responses are sent in the order of the requests.
+
+        The server runs on a single thread, with an epoll loop (Linux only).
+        The requests read in an iteration of the loop are served as a batch:
+        the tickets of all the SCORE requests of a subgame are scored together.
+     */
+    class PredictionServer
+    {
+    public:
+        /**
+            Constructor; initializes the algorithms from all the draws of the game.
+            @param game the game.
+            @param predictionAlgorithms algorithms to predict with.
+         */
+        PredictionServer(const Game &game, const std::vector<std::unique_ptr<PredictionAlgorithm>> &predictionAlgorithms);
+
+        /**
+            Listens on a Unix domain socket.
+            @exception std::runtime_error if there was an error.
+         */
+        void listenUnix(const std::string &path);
+
+        /**
+            Listens on a TCP port of the loopback interface.
+            @param port the port; if 0, a free port is chosen.
+            @return the port.
+            @exception std::runtime_error if there was an error.
+         */
+        uint16_t listenTcp(uint16_t port);
+
+        /**
+            Serves requests until stopped.
+            @param stop flag to stop serving.
+            @exception std::runtime_error if there was an error, or the platform is not supported.
+         */
+        void run(const std::atomic<bool> &stop);
+
+        ///returns the durations of the requests served, from the read of a request to the write of its response, in nanoseconds.
+        const LatencyHistogram &getLatencies() const
+        {
+            return m_latencies;
+        }
+
+    private:
+        //a client connection
+        struct Connection
+        {
+            Socket socket;
+            std::string input;
+            std::string output;
+            bool writing = false;
+            bool inputClosed = false;
+            bool closed = false;
+        };
+
+        //a request of a batch
+        struct Request
+        {
+            Connection *connection;
+            uint64_t startTime;
+            std::string response;
+        };
+
+        const Game &m_game;
+        const std::vector<std::unique_ptr<PredictionAlgorithm>> &m_predictionAlgorithms;
+        std::vector<TicketScorer> m_scorers;
+        std::vector<Socket> m_listeners;
+        std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+        std::vector<Request> m_requests;
+        std::vector<std::vector<NumberMask>> m_tickets;
+        std::vector<std::vector<size_t>> m_ticketRequests;
+        std::vector<uint32_t> m_scores;
+        LatencyHistogram m_latencies;
+        int m_pollHandle = -1;
+
+        //reads the requests of a connection; returns false if the connection failed;
+        //if the peer finished sending, the requests read are served before the connection is closed
+        bool _read(Connection &connection, uint64_t startTime);
+
+        //parses a request; the SCORE requests are queued for the batch
+        void _parse(Connection &connection, const std::string &line, uint64_t startTime);
+
+        //scores the queued tickets and sends the responses
+        void _serveBatch();
+
+        //writes the pending output of a connection; returns false if the connection was closed
+        bool _write(Connection &connection);
+
+        //sets the events waited for on a connection, according to its state
+        void _watch(Connection &connection);
+
+        //returns the index of a subgame, or SIZE_MAX if not found
+        size_t _findSubGame(const std::string &name) const;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_PREDICTIONSERVER_HPP
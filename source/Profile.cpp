@@ -0,0 +1,224 @@
+#include <cstring>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <iomanip>
+#include "Profile.hpp"
+#include "Log.hpp"
+
+
+namespace Lottery
+{
+
+
+    //profiling data of a thread
+    struct ProfileThread
+    {
+        ProfileNode root{ "", nullptr };
+        ProfileNode *current = &root;
+    };
+
+
+    //the profiling data of all threads; never freed, since threads may exit before the report
+    static std::mutex _threadsMutex;
+    static std::vector<ProfileThread *> _threads;
+
+
+    //the profiling data of the current thread
+    static thread_local ProfileThread *_thread = nullptr;
+
+
+    //returns the profiling data of the current thread
+    static ProfileThread *_getThread()
+    {
+        if (!_thread)
+        {
+            _thread = new ProfileThread;
+            std::lock_guard<std::mutex> lock(_threadsMutex);
+            if (_threads.empty())
+            {
+                std::atexit(&Profiler::report);
+            }
+            _threads.push_back(_thread);
+        }
+        return _thread;
+    }
+
+
+    //scope statistics merged from all threads
+    struct MergedProfileNode
+    {
+        std::string name;
+        LatencyHistogram durations;
+        PerfCounterValues counters;
+        uint64_t counterCount = 0;
+        std::vector<std::unique_ptr<MergedProfileNode>> children;
+
+        //merges a thread's node into this
+        void merge(const ProfileNode &node)
+        {
+            durations.merge(node.durations);
+            counters += node.counters;
+            counterCount += node.counterCount;
+            for (const auto &child : node.children)
+            {
+                MergedProfileNode *merged = nullptr;
+                for (const auto &existing : children)
+                {
+                    if (existing->name == child->name)
+                    {
+                        merged = existing.get();
+                        break;
+                    }
+                }
+                if (!merged)
+                {
+                    children.push_back(std::make_unique<MergedProfileNode>());
+                    merged = children.back().get();
+                    merged->name = child->name;
+                }
+                merged->merge(*child);
+            }
+        }
+    };
+
+
+    //formats a duration
+    static std::string _formatDuration(uint64_t ns)
+    {
+        std::stringstream stream;
+        stream << std::fixed << std::setprecision(3);
+        if (ns < 1000)
+        {
+            stream << ns << "ns";
+        }
+        else if (ns < 1000000)
+        {
+            stream << ns / 1e3 << "us";
+        }
+        else if (ns < 1000000000)
+        {
+            stream << ns / 1e6 << "ms";
+        }
+        else
+        {
+            stream << ns / 1e9 << "s";
+        }
+        return stream.str();
+    }
+
+
+    //formats the hardware counters
+    static std::string _formatCounters(const PerfCounterValues &counters, uint64_t counterCount, uint64_t callCount)
+    {
+        //scopes whose counters never ran, i.e. were always multiplexed out, have durations only
+        if (counterCount == 0)
+        {
+            return PerfCounters::isEnabled() ? " counters=time-only" : std::string();
+        }
+        std::stringstream stream;
+        stream << std::fixed << std::setprecision(2);
+        if (counterCount < callCount)
+        {
+            stream << " counted-calls=" << counterCount;
+        }
+        stream
+            << " cycles=" << counters[PerfCounter::Cycles]
+            << " instructions=" << counters[PerfCounter::Instructions]
+            << " ipc=" << (counters[PerfCounter::Cycles] ? (double)counters[PerfCounter::Instructions] / counters[PerfCounter::Cycles] : 0.0)
+            << " l1d-misses=" << counters[PerfCounter::L1DataMisses]
+            << " llc-misses=" << counters[PerfCounter::LastLevelCacheMisses]
+            << " branch-misses=" << counters[PerfCounter::BranchMisses];
+        return stream.str();
+    }
+
+
+    //writes a node and its children to the log
+    static void _report(const MergedProfileNode &node, size_t depth)
+    {
+        const LatencyHistogram &d = node.durations;
+        log(std::string(depth * 2, ' '), node.name,
+            ": calls=", d.getCount(),
+            " total=", _formatDuration(d.getTotal()),
+            " min=", _formatDuration(d.getMin()),
+            " max=", _formatDuration(d.getMax()),
+            " p50=", _formatDuration(d.getPercentile(50)),
+            " p90=", _formatDuration(d.getPercentile(90)),
+            " p99=", _formatDuration(d.getPercentile(99)),
+            _formatCounters(node.counters, node.counterCount, d.getCount()));
+        for (const auto &child : node.children)
+        {
+            _report(*child, depth + 1);
+        }
+    }
+
+
+    //returns the child with the given name
+    ProfileNode *ProfileNode::getChild(const char *childName)
+    {
+        for (const auto &child : children)
+        {
+            if (child->name == childName || std::strcmp(child->name, childName) == 0)
+            {
+                return child.get();
+            }
+        }
+        children.push_back(std::make_unique<ProfileNode>(childName, this));
+        return children.back().get();
+    }
+
+
+    //enters a scope
+    ProfileNode *Profiler::enter(const char *name)
+    {
+        ProfileThread *thread = _getThread();
+        thread->current = thread->current->getChild(name);
+        return thread->current;
+    }
+
+
+    //leaves a scope
+    void Profiler::leave(ProfileNode *node, uint64_t duration)
+    {
+        node->durations.record(duration);
+        _thread->current = node->parent;
+    }
+
+
+    //writes the report
+    void Profiler::report()
+    {
+        std::lock_guard<std::mutex> lock(_threadsMutex);
+
+        MergedProfileNode root;
+        for (const ProfileThread *thread : _threads)
+        {
+            root.merge(thread->root);
+        }
+
+        log("Profile report:");
+        for (const auto &child : root.children)
+        {
+            _report(*child, 1);
+        }
+
+        //hardware counters depend on what each thread did, so the threads are also reported separately
+        if (PerfCounters::isEnabled() && _threads.size() > 1)
+        {
+            for (size_t i = 0; i < _threads.size(); ++i)
+            {
+                MergedProfileNode threadRoot;
+                threadRoot.merge(_threads[i]->root);
+                log("Profile report of thread ", i + 1, ':');
+                for (const auto &child : threadRoot.children)
+                {
+                    _report(*child, 1);
+                }
+            }
+        }
+
+        Logger::flush();
+    }
+
+
+} //namespace Lottery
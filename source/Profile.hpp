@@ -3,7 +3,11 @@
 
 
 #include <chrono>
-#include "log.hpp"
+#include <memory>
+#include <vector>
+#include "LatencyHistogram.hpp"
+#include "PerfCounters.hpp"
+#include "Trace.hpp"
 
 
 namespace Lottery
@@ -11,36 +15,152 @@ namespace Lottery
 
 
     /**
-        Profile point.
+        Statistics of a profiled scope, within the scope that encloses it.
+        Each thread has its own tree of nodes.
      */
-    class ProfilePoint
+    struct ProfileNode
+    {
+        ///name of the scope.
+        const char *name;
+
+        ///enclosing scope; null for the root.
+        ProfileNode *parent;
+
+        ///enclosed scopes.
+        std::vector<std::unique_ptr<ProfileNode>> children;
+
+        ///durations of the scope, in nanoseconds.
+        LatencyHistogram durations;
+
+        ///hardware counters accumulated over the calls of the scope.
+        PerfCounterValues counters;
+
+        ///number of calls for which the hardware counters were read and counting.
+        uint64_t counterCount = 0;
+
+        ///constructor.
+        ProfileNode(const char *n, ProfileNode *p)
+            : name(n)
+            , parent(p)
+        {
+        }
+
+        ///returns the child with the given name, creating it if it does not exist.
+        ProfileNode *getChild(const char *childName);
+    };
+
+
+    /**
+        Aggregating profiler.
+        Scopes are recorded into per-thread trees, without locking;
+        the trees are merged by scope path when reporting.
+     */
+    class Profiler
+    {
+    public:
+        ///returns the current time in nanoseconds.
+        static uint64_t now()
+        {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        /**
+            Enters a scope of the current thread.
+            The name must remain valid until the end of the program (i.e. a string literal).
+            @return the node of the scope.
+         */
+        static ProfileNode *enter(const char *name);
+
+        /**
+            Leaves the current scope of the current thread.
+            @param node node returned from enter.
+            @param duration duration of the scope, in nanoseconds.
+         */
+        static void leave(ProfileNode *node, uint64_t duration);
+
+        /**
+            Writes the tree of scopes of all threads to the log, and waits until it is written,
+            with call count, total, min, max and percentiles per scope path,
+            and the hardware counters, if they were read.
+            With hardware counters, the tree of each thread is also written.
+            It is called automatically at exit, if any scope was profiled.
+         */
+        static void report();
+    };
+
+
+    /**
+        Profiles the enclosing scope.
+        If hardware counters are enabled, they are read on entering and leaving.
+        If tracing is enabled, the scope is also recorded as a timeline event.
+     */
+    class ProfileScope
     {
     public:
         /**
-            Records the current time.
+            Enters the scope.
+         */
+        ProfileScope(const char *name)
+            : m_node(Profiler::enter(name))
+        {
+            _start();
+        }
+
+        /**
+            Enters the scope, with details for the trace.
+            @param name name of the scope.
+            @param detail detail of the scope; it must remain valid until the end of the program (see Trace::intern).
+            @param arg0 first argument of the scope.
+            @param arg1 second argument of the scope.
          */
-        ProfilePoint(const char *name)
-            : m_name(name)
-            , m_startTime(std::chrono::high_resolution_clock::now())
+        ProfileScope(const char *name, const char *detail, int64_t arg0, int64_t arg1)
+            : m_node(Profiler::enter(name))
+            , m_detail(detail)
+            , m_arg0(arg0)
+            , m_arg1(arg1)
         {
-                LOTTERY_LOG("Profile begin: ", m_name);
+            _start();
         }
 
         /**
-            Prints the time delta between constructor and destructor.
+            Leaves the scope, recording its duration.
          */
-        ~ProfilePoint()
+        ~ProfileScope()
         {
-                const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
-                const auto duration = endTime - m_startTime;
-                const auto durationSecs = std::chrono::duration_cast<std::chrono::seconds>(duration);
-                const auto durationMS = std::chrono::duration_cast<std::chrono::milliseconds>(duration - durationSecs);
-                LOTTERY_LOG("Profile end: ", m_name, ": ", durationSecs.count(), " secs, ", durationMS.count(), " msecs");
+            const uint64_t duration = Profiler::now() - m_startTime;
+            if (m_countersRead)
+            {
+                PerfCounterValues endCounters;
+                if (PerfCounters::read(endCounters) && m_node->counters.addDifference(m_startCounters, endCounters))
+                {
+                    ++m_node->counterCount;
+                }
+            }
+            Profiler::leave(m_node, duration);
+            if (Trace::isEnabled())
+            {
+                Trace::record(m_node->name, m_startTime, duration, m_detail, m_arg0, m_arg1);
+            }
         }
 
+        ProfileScope(const ProfileScope &) = delete;
+        ProfileScope &operator = (const ProfileScope &) = delete;
+
     private:
-        const char *m_name;
-        std::chrono::high_resolution_clock::time_point m_startTime;
+        ProfileNode *m_node;
+        uint64_t m_startTime;
+        const char *m_detail = nullptr;
+        int64_t m_arg0 = 0;
+        int64_t m_arg1 = 0;
+        bool m_countersRead = false;
+        PerfCounterValues m_startCounters;
+
+        //reads the start counters and time
+        void _start()
+        {
+            m_countersRead = PerfCounters::isEnabled() && PerfCounters::read(m_startCounters);
+            m_startTime = Profiler::now();
+        }
     };
 
 
@@ -48,9 +168,11 @@ namespace Lottery
 
 
 #ifdef LOTTERY_ENABLE_PROFILING
-#define LOTTERY_PROFILE(NAME) Lottery::ProfilePoint profilePoint##NAME(#NAME);
+#define LOTTERY_PROFILE(NAME) Lottery::ProfileScope profileScope##NAME(#NAME);
+#define LOTTERY_PROFILE_DETAIL(NAME, DETAIL, ARG0, ARG1) Lottery::ProfileScope profileScope##NAME(#NAME, DETAIL, (int64_t)(ARG0), (int64_t)(ARG1));
 #else
 #define LOTTERY_PROFILE(NAME) 
+#define LOTTERY_PROFILE_DETAIL(NAME, DETAIL, ARG0, ARG1) 
 #endif
 
 
@@ -1,24 +1,112 @@
-#include <random>
+#include <sstream>
 #include "RandomPredictionAlgorithm.hpp"
+#include "BinaryIO.hpp"
 
 
 namespace Lottery
 {
 
 
+    //constructor
+    RandomPredictionAlgorithm::RandomPredictionAlgorithm(const Game &game)
+        : m_seeded(false)
+    {
+        std::random_device randomDevice;
+        for (const SubGame &subGame : game.getSubGames())
+        {
+            m_subGameNames.push_back(subGame.getName());
+            m_randomEngines.emplace_back(randomDevice());
+        }
+    }
+
+
+    //constructor with seed
+    RandomPredictionAlgorithm::RandomPredictionAlgorithm(const Game &game, uint64_t seed)
+        : m_seed(seed)
+        , m_seeded(true)
+    {
+        for (const SubGame &subGame : game.getSubGames())
+        {
+            m_subGameNames.push_back(subGame.getName());
+            m_randomEngines.emplace_back(seed + m_randomEngines.size());
+        }
+    }
+
+
     //predict random numbers
-    void RandomPredictionAlgorithm::predict(const SubGame &subGame, const DrawVectorRange &previousDraws, Prediction &prediction)
+    void RandomPredictionAlgorithm::predict(const SubGame &subGame, const DrawVectorRange &/*previousDraws*/, Prediction &prediction)
+    {
+        _predict(subGame, _getRandomEngine(subGame), prediction);
+    }
+
+
+    //predict random numbers for consecutive draws
+    void RandomPredictionAlgorithm::predictBatch(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, Prediction *predictions)
+    {
+        std::mt19937_64 &randomEngine = _getRandomEngine(subGame);
+        for (size_t drawIndex = beginDrawIndex; drawIndex < endDrawIndex; ++drawIndex)
+        {
+            _predict(subGame, randomEngine, predictions[drawIndex - beginDrawIndex]);
+        }
+    }
+
+
+    //saves the random engines
+    void RandomPredictionAlgorithm::saveState(std::ostream &stream) const
     {
-        //random device to use
-        std::random_device rd;
+        writeBinary(stream, (uint64_t)m_randomEngines.size());
+        for (const std::mt19937_64 &randomEngine : m_randomEngines)
+        {
+            std::stringstream engineStream;
+            engineStream << randomEngine;
+            writeBinary(stream, engineStream.str());
+        }
+    }
+
 
+    //loads the random engines
+    void RandomPredictionAlgorithm::loadState(std::istream &stream)
+    {
+        if (readBinary<uint64_t>(stream) != m_randomEngines.size())
+        {
+            throw std::runtime_error("invalid random engine state");
+        }
+        for (std::mt19937_64 &randomEngine : m_randomEngines)
+        {
+            std::stringstream engineStream(readBinary<std::string>(stream));
+            engineStream >> randomEngine;
+            if (engineStream.fail())
+            {
+                throw std::runtime_error("invalid random engine state");
+            }
+        }
+    }
+
+
+    //returns the engine of a subgame
+    std::mt19937_64 &RandomPredictionAlgorithm::_getRandomEngine(const SubGame &subGame)
+    {
+        for (size_t i = 0; i < m_subGameNames.size(); ++i)
+        {
+            if (m_subGameNames[i] == subGame.getName())
+            {
+                return m_randomEngines[i];
+            }
+        }
+        throw std::runtime_error("the subgame does not belong to the game of the random algorithm");
+    }
+
+
+    //fills a prediction with random numbers
+    void RandomPredictionAlgorithm::_predict(const SubGame &subGame, std::mt19937_64 &randomEngine, Prediction &prediction)
+    {
         //numeric distribution
         std::uniform_int_distribution<size_t> uid(subGame.getMinNumber(), subGame.getMaxNumber());
-            
+
         //fill the requested number of numbers to predict
         while (prediction.numbers.size() < prediction.count)
         {
-            const Number randomNumber = (Number)uid(rd);
+            const Number randomNumber = (Number)uid(randomEngine);
             prediction.numbers.insert(randomNumber);
         }
     }
@@ -2,6 +2,8 @@
 #define LOTTERY_RANDOMPREDICTIONALGORITHM_HPP
 
 
+#include <random>
+#include <vector>
 #include "PredictionAlgorithm.hpp"
 
 
@@ -11,6 +13,8 @@ namespace Lottery
 
     /**
         Random prediction algorithm.
+        Each subgame has its own random engine, so that the predictions of a subgame
+        do not depend on the order in which the subgames are predicted.
      */
     class RandomPredictionAlgorithm : public PredictionAlgorithm
     {
@@ -18,9 +22,13 @@ namespace Lottery
         /**
             The constructor.
          */
-        RandomPredictionAlgorithm(const Game &game)
-        {
-        }
+        RandomPredictionAlgorithm(const Game &game);
+
+        /**
+            The constructor with a fixed seed, for reproducible predictions;
+            the engine of each subgame is seeded with the seed plus the subgame index.
+         */
+        RandomPredictionAlgorithm(const Game &game, uint64_t seed);
 
         /**
             Returns the algorithm's name.
@@ -30,12 +38,42 @@ namespace Lottery
             return "Random";
         }
 
+        /**
+            Returns the algorithm's version.
+         */
+        virtual std::string getVersion() const
+        {
+            return "2";
+        }
+
+        /**
+            Returns the seed, if one was given.
+         */
+        virtual std::string getParameters() const
+        {
+            return m_seeded ? "seed=" + std::to_string(m_seed) : std::string();
+        }
+
+        /**
+            The predictions are reproducible only if a seed was given.
+         */
+        virtual bool isDeterministic() const
+        {
+            return m_seeded;
+        }
+
+        ///the random prediction model does not read the draws.
+        virtual bool readsDraws() const
+        {
+            return false;
+        }
+
         /**
             Does nothing for the random prediction model.
             @param subGame the sub-game for which the sample draws are about.
             @param sampleDraws sample draws to initialize the prediction model from.
          */
-        virtual void initialize(const SubGame &subGame, const DrawVectorRange &sampleDraws)
+        virtual void initialize(const SubGame &/*subGame*/, const DrawVectorRange &/*sampleDraws*/)
         {
         }
 
@@ -47,14 +85,52 @@ namespace Lottery
          */
         virtual void predict(const SubGame &subGame, const DrawVectorRange &previousDraws, Prediction &prediction);
 
+        /**
+            Creates random numbers for consecutive draws, with the engine looked up once.
+            @param subGame the sub-game for which the draws are about.
+            @param beginDrawIndex index of the first draw to predict.
+            @param endDrawIndex index of the draw after the last draw to predict.
+            @param predictions one prediction per draw.
+         */
+        virtual void predictBatch(const SubGame &subGame, size_t beginDrawIndex, size_t endDrawIndex, Prediction *predictions);
+
         /**
             Does nothing for the random prediction model.
             @param subGame the sub-game for which the sample draws are about.
             @param sampleDraws sample draws to initialize the prediction model from.
          */
-        virtual void finalize(const SubGame &subGame, const DrawVectorRange &sampleDraws)
+        virtual void finalize(const SubGame &/*subGame*/, const DrawVectorRange &/*sampleDraws*/)
         {
         }
+
+        /**
+            Saves the state of the random engines.
+            @param stream binary stream to write the state to.
+         */
+        virtual void saveState(std::ostream &stream) const;
+
+        /**
+            Restores the state of the random engines.
+            @param stream binary stream to read the state from.
+         */
+        virtual void loadState(std::istream &stream);
+
+    private:
+        //names of the subgames, in the order of the engines
+        std::vector<std::string> m_subGameNames;
+
+        //random engine per subgame
+        std::pmr::vector<std::mt19937_64> m_randomEngines{ getStateMemory() };
+
+        //seed
+        uint64_t m_seed = 0;
+        bool m_seeded;
+
+        //returns the engine of a subgame
+        std::mt19937_64 &_getRandomEngine(const SubGame &subGame);
+
+        //fills a prediction with random numbers
+        static void _predict(const SubGame &subGame, std::mt19937_64 &randomEngine, Prediction &prediction);
     };
 
 
@@ -0,0 +1,201 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <filesystem>
+#include "ResultCache.hpp"
+#include "BinaryIO.hpp"
+#include "Hash.hpp"
+
+
+namespace Lottery
+{
+
+
+    //cache file identification
+    static constexpr uint32_t ResultCacheMagic = 0x4352544c;
+    static constexpr uint32_t ResultCacheVersion = 2;
+
+
+    //writes the key to a file
+    static void _writeKey(std::ostream &stream, const ResultCacheKey &key)
+    {
+        writeBinary(stream, key.algorithm);
+        writeBinary(stream, key.version);
+        writeBinary(stream, key.parameters);
+        writeBinary(stream, key.subGame);
+        writeBinary(stream, (uint64_t)key.drawsHash);
+        writeBinary(stream, (uint64_t)key.sampleSize);
+        writeBinary(stream, (uint64_t)key.endDrawIndex);
+    }
+
+
+    //reads the key from a file
+    static ResultCacheKey _readKey(std::istream &stream)
+    {
+        ResultCacheKey key;
+        readBinary(stream, key.algorithm);
+        readBinary(stream, key.version);
+        readBinary(stream, key.parameters);
+        readBinary(stream, key.subGame);
+        key.drawsHash = (size_t)readBinary<uint64_t>(stream);
+        key.sampleSize = (size_t)readBinary<uint64_t>(stream);
+        key.endDrawIndex = (size_t)readBinary<uint64_t>(stream);
+        return key;
+    }
+
+
+    //creates a key
+    ResultCacheKey ResultCacheKey::create(
+        const PredictionAlgorithm &algorithm,
+        const SubGame &subGame,
+        size_t sampleSize,
+        size_t endDrawIndex)
+    {
+        ResultCacheKey key;
+        key.algorithm = algorithm.getName();
+        key.version = algorithm.getVersion();
+        key.parameters = algorithm.getParameters();
+        key.subGame = subGame.getName();
+        key.sampleSize = sampleSize;
+        key.endDrawIndex = endDrawIndex;
+
+        //hash the subgame definition and the draws
+        size_t seed = 0;
+        boost::hash_combine(seed, subGame.getMinNumber());
+        boost::hash_combine(seed, subGame.getMaxNumber());
+        boost::hash_combine(seed, subGame.getNumberCount());
+        for (size_t i = 0; i < endDrawIndex && i < subGame.getDrawsCount(); ++i)
+        {
+            //hashed as std::hash<Draw> does, from the layout loaded
+            size_t drawSeed = 0;
+            for (size_t position = 0; position < subGame.getNumberCount(); ++position)
+            {
+                boost::hash_combine(drawSeed, subGame.getNumber(i, position));
+            }
+            boost::hash_combine(seed, drawSeed);
+        }
+        key.drawsHash = seed;
+
+        return key;
+    }
+
+
+    //returns the hash of the key
+    size_t ResultCacheKey::hash() const
+    {
+        return std::hash<std::tuple<std::string, std::string, std::string, std::string, size_t, size_t, size_t>>()(
+            std::make_tuple(algorithm, version, parameters, subGame, drawsHash, sampleSize, endDrawIndex));
+    }
+
+
+    //compares keys
+    bool ResultCacheKey::operator == (const ResultCacheKey &other) const
+    {
+        return
+            algorithm == other.algorithm &&
+            version == other.version &&
+            parameters == other.parameters &&
+            subGame == other.subGame &&
+            drawsHash == other.drawsHash &&
+            sampleSize == other.sampleSize &&
+            endDrawIndex == other.endDrawIndex;
+    }
+
+
+    //constructor
+    ResultCache::ResultCache(const std::string &directory)
+        : m_directory(directory)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+        if (error)
+        {
+            throw std::runtime_error("the result cache directory could not be created: " + error.message());
+        }
+    }
+
+
+    //finds an entry
+    bool ResultCache::find(const ResultCacheKey &key, std::vector<uint64_t> &successes) const
+    {
+        std::ifstream file(_getFilename(key), std::ios_base::in | std::ios_base::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        try
+        {
+            if (readBinary<uint32_t>(file) != ResultCacheMagic || readBinary<uint32_t>(file) != ResultCacheVersion)
+            {
+                return false;
+            }
+
+            //in case of hash collision
+            if (!(_readKey(file) == key))
+            {
+                return false;
+            }
+
+            readBinary(file, successes);
+            return true;
+        }
+        catch (const std::runtime_error &)
+        {
+            return false;
+        }
+    }
+
+
+    //stores an entry
+    void ResultCache::store(const ResultCacheKey &key, const std::vector<uint64_t> &successes) const
+    {
+        const std::string filename = _getFilename(key);
+
+        //other processes may be writing the same entry, so the temporary name must be unique
+        std::stringstream tempFilename;
+        tempFilename << filename << '.' << std::hex << std::random_device()() << std::random_device()() << ".tmp";
+
+        try
+        {
+            {
+                std::ofstream file(tempFilename.str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+                if (!file.is_open())
+                {
+                    return;
+                }
+
+                writeBinary(file, ResultCacheMagic);
+                writeBinary(file, ResultCacheVersion);
+                _writeKey(file, key);
+                writeBinary(file, successes);
+
+                file.flush();
+                if (!file.good())
+                {
+                    throw std::runtime_error("the result cache file could not be written");
+                }
+            }
+
+            //publish the entry; if another process stored it in the meantime, the content is the same
+            std::filesystem::rename(tempFilename.str(), filename);
+        }
+        catch (const std::exception &)
+        {
+            std::error_code error;
+            std::filesystem::remove(tempFilename.str(), error);
+        }
+    }
+
+
+    //returns the filename for the key
+    std::string ResultCache::_getFilename(const ResultCacheKey &key) const
+    {
+        std::stringstream stream;
+        stream << m_directory << '/' << std::hex << std::setw(16) << std::setfill('0') << key.hash() << ".result";
+        return stream.str();
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,106 @@
+#ifndef LOTTERY_RESULTCACHE_HPP
+#define LOTTERY_RESULTCACHE_HPP
+
+
+#include <string>
+#include <vector>
+#include "PredictionAlgorithm.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Identifies the result of testing an algorithm
+        against the draws of a subgame.
+     */
+    struct ResultCacheKey
+    {
+        ///algorithm name.
+        std::string algorithm;
+
+        ///algorithm version.
+        std::string version;
+
+        ///algorithm parameters.
+        std::string parameters;
+
+        ///subgame name.
+        std::string subGame;
+
+        ///hash of the draws used.
+        size_t drawsHash;
+
+        ///number of sample draws.
+        size_t sampleSize;
+
+        ///index of the draw the test stops at.
+        size_t endDrawIndex;
+
+        /**
+            Creates a key.
+            @param algorithm algorithm.
+            @param subGame subgame.
+            @param sampleSize number of sample draws.
+            @param endDrawIndex index of the draw the test stops at;
+                the draws from 0 to it are hashed.
+         */
+        static ResultCacheKey create(
+            const PredictionAlgorithm &algorithm,
+            const SubGame &subGame,
+            size_t sampleSize,
+            size_t endDrawIndex);
+
+        ///returns the hash of the key.
+        size_t hash() const;
+
+        ///compares keys.
+        bool operator == (const ResultCacheKey &other) const;
+    };
+
+
+    /**
+        Disk cache of backtest results.
+        Each entry is a file named after the hash of its key,
+        written under a unique temporary name and then renamed,
+        so that many processes can share the same directory.
+     */
+    class ResultCache
+    {
+    public:
+        /**
+            Constructor.
+            @param directory directory of the cache; it is created if it does not exist.
+            @exception std::runtime_error if the directory could not be created.
+         */
+        ResultCache(const std::string &directory);
+
+        /**
+            Finds the successes of the given key.
+            @param key key.
+            @param successes the result; count of draws per count of numbers found.
+            @return true if found, false otherwise.
+         */
+        bool find(const ResultCacheKey &key, std::vector<uint64_t> &successes) const;
+
+        /**
+            Stores the successes of the given key.
+            Errors are ignored, since the cache is an optimization.
+            @param key key.
+            @param successes the result; count of draws per count of numbers found.
+         */
+        void store(const ResultCacheKey &key, const std::vector<uint64_t> &successes) const;
+
+    private:
+        std::string m_directory;
+
+        //returns the filename for the key
+        std::string _getFilename(const ResultCacheKey &key) const;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_RESULTCACHE_HPP
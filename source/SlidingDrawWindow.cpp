@@ -0,0 +1,133 @@
+#include <stdexcept>
+#include "SlidingDrawWindow.hpp"
+
+
+namespace Lottery
+{
+
+
+    //constructor
+    SlidingDrawWindow::SlidingDrawWindow(const SubGame &subGame, size_t windowSize)
+        : m_subGame(subGame)
+        , m_windowSize(windowSize)
+        , m_occurrences(subGame.getNumberSpan(), 0)
+        , m_columnSums(subGame.getNumberCount(), 0)
+    {
+    }
+
+
+    //adds hooks
+    void SlidingDrawWindow::addHooks(const Hook &onAdd, const Hook &onRemove)
+    {
+        if (onAdd)
+        {
+            for (const Draw &draw : getDraws())
+            {
+                onAdd(draw);
+            }
+            m_addHooks.push_back(onAdd);
+        }
+        if (onRemove)
+        {
+            m_removeHooks.push_back(onRemove);
+        }
+    }
+
+
+    //advances the window by one draw
+    bool SlidingDrawWindow::advance()
+    {
+        if (m_endDrawIndex >= m_subGame.getDrawsCount())
+        {
+            return false;
+        }
+
+        //an empty window only moves
+        if (m_windowSize == 0)
+        {
+            ++m_beginDrawIndex;
+            ++m_endDrawIndex;
+            return true;
+        }
+
+        //the hooks receive draws, so the window reads the rows
+        const DrawVector &draws = m_subGame.getDraws();
+
+        //remove the oldest draw first, so that hooks see at most windowSize draws
+        if (size() == m_windowSize)
+        {
+            const Draw &oldest = draws[m_beginDrawIndex];
+            _remove(oldest);
+            ++m_beginDrawIndex;
+            for (const Hook &hook : m_removeHooks)
+            {
+                hook(oldest);
+            }
+        }
+
+        const Draw &newest = draws[m_endDrawIndex];
+        _add(newest);
+        ++m_endDrawIndex;
+        for (const Hook &hook : m_addHooks)
+        {
+            hook(newest);
+        }
+
+        return true;
+    }
+
+
+    //advances the window to the given end
+    void SlidingDrawWindow::advanceTo(size_t endDrawIndex)
+    {
+        if (endDrawIndex < m_endDrawIndex || endDrawIndex > m_subGame.getDrawsCount())
+        {
+            throw std::runtime_error("invalid sliding window end draw index");
+        }
+
+        //draws that would enter and leave the window within the jump are skipped
+        if (endDrawIndex - m_endDrawIndex > m_windowSize && m_addHooks.empty() && m_removeHooks.empty())
+        {
+            for (const Draw &draw : getDraws())
+            {
+                _remove(draw);
+            }
+            m_endDrawIndex = m_beginDrawIndex = endDrawIndex - m_windowSize;
+        }
+
+        while (m_endDrawIndex < endDrawIndex)
+        {
+            advance();
+        }
+    }
+
+
+    //adds a draw to the aggregates
+    void SlidingDrawWindow::_add(const Draw &draw)
+    {
+        for (size_t column = 0; column < draw.size(); ++column)
+        {
+            const Number number = draw[column];
+            ++m_occurrences[number - m_subGame.getMinNumber()];
+            m_columnSums[column] += number;
+            m_sum += number;
+            m_oddCount += number & 1;
+        }
+    }
+
+
+    //removes a draw from the aggregates
+    void SlidingDrawWindow::_remove(const Draw &draw)
+    {
+        for (size_t column = 0; column < draw.size(); ++column)
+        {
+            const Number number = draw[column];
+            --m_occurrences[number - m_subGame.getMinNumber()];
+            m_columnSums[column] -= number;
+            m_sum -= number;
+            m_oddCount -= number & 1;
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,158 @@
+#ifndef LOTTERY_SLIDINGDRAWWINDOW_HPP
+#define LOTTERY_SLIDINGDRAWWINDOW_HPP
+
+
+#include <vector>
+#include <functional>
+#include "SubGame.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        A window over the last draws of a subgame, which advances one draw at a time.
+        When a draw enters or leaves the window, the built-in aggregates
+        (occurrences per number, number sums per column and in total, odd/even counts)
+        are updated, and the registered hooks are invoked, in O(numberCount) per draw;
+        therefore walking the window over all the draws is linear in the number of draws.
+     */
+    class SlidingDrawWindow
+    {
+    public:
+        ///function invoked for a draw that enters or leaves the window.
+        typedef std::function<void(const Draw &draw)> Hook;
+
+        /**
+            Constructor.
+            The window is initially empty, at the start of the draws.
+            @param subGame subgame whose draws the window is over.
+            @param windowSize maximum number of draws in the window.
+         */
+        SlidingDrawWindow(const SubGame &subGame, size_t windowSize);
+
+        /**
+            Registers hooks invoked when a draw enters or leaves the window.
+            The add hook is invoked for the draws already in the window.
+            @param onAdd invoked when a draw enters the window; may be null.
+            @param onRemove invoked when a draw leaves the window; may be null.
+         */
+        void addHooks(const Hook &onAdd, const Hook &onRemove);
+
+        /**
+            Adds the next draw to the window, removing the oldest draw if the window is full.
+            @return false if there are no more draws, true otherwise.
+         */
+        bool advance();
+
+        /**
+            Advances the window until its end is at the given draw index.
+            @param endDrawIndex index of the draw after the last draw of the window;
+                it must not be less than the current end index.
+         */
+        void advanceTo(size_t endDrawIndex);
+
+        ///returns the subgame.
+        const SubGame &getSubGame() const
+        {
+            return m_subGame;
+        }
+
+        ///returns the maximum number of draws in the window.
+        size_t getWindowSize() const
+        {
+            return m_windowSize;
+        }
+
+        ///returns the index of the first draw in the window.
+        size_t getBeginDrawIndex() const
+        {
+            return m_beginDrawIndex;
+        }
+
+        ///returns the index of the draw after the last draw in the window.
+        size_t getEndDrawIndex() const
+        {
+            return m_endDrawIndex;
+        }
+
+        ///returns the number of draws in the window.
+        size_t size() const
+        {
+            return m_endDrawIndex - m_beginDrawIndex;
+        }
+
+        ///returns the draws in the window.
+        DrawVectorRange getDraws() const
+        {
+            return DrawVectorRange(m_subGame.getDraws().begin() + m_beginDrawIndex, m_subGame.getDraws().begin() + m_endDrawIndex);
+        }
+
+        ///returns how many times the given number occurs in the window.
+        size_t getOccurrences(Number number) const
+        {
+            return m_occurrences[number - m_subGame.getMinNumber()];
+        }
+
+        ///returns the occurrences of the numbers, indexed by number - min number.
+        const std::vector<size_t> &getOccurrences() const
+        {
+            return m_occurrences;
+        }
+
+        ///returns the sum of the numbers at the given column of the draws in the window.
+        uint64_t getColumnSum(size_t column) const
+        {
+            return m_columnSums[column];
+        }
+
+        ///returns the sum of all numbers in the window.
+        uint64_t getSum() const
+        {
+            return m_sum;
+        }
+
+        ///returns the mean of the numbers in the window.
+        double getMean() const
+        {
+            const size_t count = size() * m_subGame.getNumberCount();
+            return count ? (double)m_sum / count : 0;
+        }
+
+        ///returns the count of odd numbers in the window.
+        size_t getOddCount() const
+        {
+            return m_oddCount;
+        }
+
+        ///returns the count of even numbers in the window.
+        size_t getEvenCount() const
+        {
+            return size() * m_subGame.getNumberCount() - m_oddCount;
+        }
+
+    private:
+        const SubGame &m_subGame;
+        size_t m_windowSize;
+        size_t m_beginDrawIndex = 0;
+        size_t m_endDrawIndex = 0;
+        std::vector<size_t> m_occurrences;
+        std::vector<uint64_t> m_columnSums;
+        uint64_t m_sum = 0;
+        size_t m_oddCount = 0;
+        std::vector<Hook> m_addHooks;
+        std::vector<Hook> m_removeHooks;
+
+        //adds a draw to the aggregates
+        void _add(const Draw &draw);
+
+        //removes a draw from the aggregates
+        void _remove(const Draw &draw);
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_SLIDINGDRAWWINDOW_HPP
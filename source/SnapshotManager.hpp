@@ -0,0 +1,249 @@
+#ifndef LOTTERY_SNAPSHOTMANAGER_HPP
+#define LOTTERY_SNAPSHOTMANAGER_HPP
+
+
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Publishes immutable versions (snapshots) of an object to concurrent readers.
+
+        Readers pin the current version and use it for as long as the pin exists;
+        pinning takes no locks. A writer publishes a new version by swapping
+        the current version pointer (read-copy-update); i.e. for a game,
+        the writer copies the current version, appends the new draws to the copy,
+        and publishes it, while readers keep using the versions they pinned.
+
+        Replaced versions are reclaimed by epochs: a pin records the epoch
+        it was taken at, and a version replaced at an epoch is freed once
+        all the pins are from later epochs.
+
+        There must be one writer at a time. A pin takes a reader slot;
+        if all slots are taken, pinning waits for a slot to be released.
+     */
+    template <class T> class SnapshotManager
+    {
+    private:
+        struct Version;
+
+    public:
+        ///number of reader slots; the maximum number of pins held at the same time.
+        static constexpr size_t SlotCount = 256;
+
+        /**
+            A pinned version.
+            The version is not reclaimed while the pin exists.
+         */
+        class Pin
+        {
+        public:
+            ///empty pin.
+            Pin()
+            {
+            }
+
+            ///moves a pin.
+            Pin(Pin &&other)
+                : m_slot(other.m_slot)
+                , m_version(other.m_version)
+            {
+                other.m_slot = nullptr;
+                other.m_version = nullptr;
+            }
+
+            ///moves a pin.
+            Pin &operator = (Pin &&other)
+            {
+                if (this != &other)
+                {
+                    release();
+                    std::swap(m_slot, other.m_slot);
+                    std::swap(m_version, other.m_version);
+                }
+                return *this;
+            }
+
+            Pin(const Pin &) = delete;
+            Pin &operator = (const Pin &) = delete;
+
+            ///releases the pin.
+            ~Pin()
+            {
+                release();
+            }
+
+            ///releases the pin; the version must not be used after this.
+            void release()
+            {
+                if (m_slot)
+                {
+                    m_slot->store(Idle, std::memory_order_release);
+                    m_slot = nullptr;
+                    m_version = nullptr;
+                }
+            }
+
+            ///returns true if a version is pinned.
+            explicit operator bool() const
+            {
+                return m_version != nullptr;
+            }
+
+            ///returns the pinned version.
+            const T &operator *() const
+            {
+                return *m_version->value;
+            }
+
+            ///returns the pinned version.
+            const T *operator ->() const
+            {
+                return m_version->value.get();
+            }
+
+            ///returns the number of the pinned version; the initial version is 0.
+            uint64_t getVersion() const
+            {
+                return m_version->number;
+            }
+
+        private:
+            std::atomic<uint64_t> *m_slot = nullptr;
+            const Version *m_version = nullptr;
+
+            Pin(std::atomic<uint64_t> *slot, const Version *version)
+                : m_slot(slot)
+                , m_version(version)
+            {
+            }
+
+            friend class SnapshotManager;
+        };
+
+        /**
+            Constructor.
+            @param value the initial version.
+         */
+        explicit SnapshotManager(std::unique_ptr<const T> value)
+            : m_current(new Version{ std::move(value), 0 })
+        {
+        }
+
+        ///destructor; there must be no pins.
+        ~SnapshotManager()
+        {
+            delete m_current.load();
+        }
+
+        SnapshotManager(const SnapshotManager &) = delete;
+        SnapshotManager &operator = (const SnapshotManager &) = delete;
+
+        /**
+            Pins the current version.
+            It is lock-free, unless all the reader slots are taken.
+         */
+        Pin pin() const
+        {
+            static thread_local const size_t firstSlot = std::hash<std::thread::id>()(std::this_thread::get_id()) % SlotCount;
+            for (;;)
+            {
+                for (size_t i = 0; i < SlotCount; ++i)
+                {
+                    std::atomic<uint64_t> &slot = m_slots[(firstSlot + i) % SlotCount].epoch;
+                    uint64_t idle = Idle;
+                    if (slot.load(std::memory_order_relaxed) == Idle && slot.compare_exchange_strong(idle, m_epoch.load()))
+                    {
+                        //the version is loaded after the slot is taken, so a version
+                        //replaced after the epoch read is not reclaimed while pinned
+                        return Pin(&slot, m_current.load());
+                    }
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+            Publishes a new version; the replaced version is reclaimed
+            when it is no longer pinned, by this or a later call to publish or reclaim.
+            Only one thread may publish at a time.
+            @param value the new version.
+         */
+        void publish(std::unique_ptr<const T> value)
+        {
+            const Version *previous = m_current.load();
+            const Version *version = m_current.exchange(new Version{ std::move(value), previous->number + 1 });
+            m_retired.push_back(Retired{ std::unique_ptr<const Version>(version), m_epoch.fetch_add(1) });
+            reclaim();
+        }
+
+        /**
+            Frees the replaced versions that are not pinned.
+            It must be called from the thread which publishes.
+            @return the number of replaced versions still pinned.
+         */
+        size_t reclaim()
+        {
+            uint64_t minEpoch = Idle;
+            for (const Slot &slot : m_slots)
+            {
+                minEpoch = std::min(minEpoch, slot.epoch.load());
+            }
+
+            m_retired.erase(
+                std::remove_if(m_retired.begin(), m_retired.end(), [&](const Retired &retired) { return retired.epoch < minEpoch; }),
+                m_retired.end());
+
+            return m_retired.size();
+        }
+
+        ///returns the number of the current version.
+        uint64_t getVersion() const
+        {
+            return m_current.load()->number;
+        }
+
+    private:
+        //value of a slot not pinning a version
+        static constexpr uint64_t Idle = UINT64_MAX;
+
+        struct Version
+        {
+            std::unique_ptr<const T> value;
+            uint64_t number;
+        };
+
+        //epoch a reader pinned at, one per cache line
+        struct alignas(64) Slot
+        {
+            std::atomic<uint64_t> epoch{ Idle };
+        };
+
+        //a replaced version and the epoch it was replaced at
+        struct Retired
+        {
+            std::unique_ptr<const Version> version;
+            uint64_t epoch;
+        };
+
+        std::atomic<const Version *> m_current;
+        std::atomic<uint64_t> m_epoch{ 0 };
+        mutable std::array<Slot, SlotCount> m_slots;
+        std::vector<Retired> m_retired;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_SNAPSHOTMANAGER_HPP
@@ -0,0 +1,435 @@
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include "Socket.hpp"
+
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+
+namespace Lottery
+{
+
+
+    //throws an error with the description of errno
+    static void _throwError(const std::string &operation)
+    {
+        throw std::runtime_error(operation + " failed: " + std::strerror(errno));
+    }
+
+
+#ifndef _WIN32
+
+
+    //creates a Unix domain socket address
+    static sockaddr_un _getUnixAddress(const std::string &path)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            throw std::runtime_error("socket path too long: " + path);
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+
+    //moves a socket
+    Socket &Socket::operator = (Socket &&other)
+    {
+        if (this != &other)
+        {
+            close();
+            m_handle = other.m_handle;
+            other.m_handle = -1;
+        }
+        return *this;
+    }
+
+
+    //listens on a Unix domain socket
+    Socket Socket::listenUnix(const std::string &path)
+    {
+        Socket result(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!result.isValid())
+        {
+            _throwError("socket");
+        }
+
+        const sockaddr_un address = _getUnixAddress(path);
+
+        //remove only a stale socket, never another kind of file
+        struct stat status;
+        if (::lstat(path.c_str(), &status) == 0)
+        {
+            if (!S_ISSOCK(status.st_mode))
+            {
+                throw std::runtime_error("the path exists and is not a socket: " + path);
+            }
+
+            //a socket is stale if nothing listens on it; the probe does not block if the backlog of a live server is full
+            Socket probe(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0));
+            if (!probe.isValid())
+            {
+                _throwError("socket");
+            }
+            if (::connect(probe.m_handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0 || errno == EAGAIN)
+            {
+                throw std::runtime_error("another server is listening on: " + path);
+            }
+            if (errno != ECONNREFUSED)
+            {
+                _throwError("connect to " + path);
+            }
+
+            if (::unlink(path.c_str()) != 0)
+            {
+                _throwError("unlink " + path);
+            }
+        }
+        else if (errno != ENOENT)
+        {
+            _throwError("lstat " + path);
+        }
+
+        if (::bind(result.m_handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            _throwError("bind to " + path);
+        }
+
+        if (::listen(result.m_handle, SOMAXCONN) != 0)
+        {
+            _throwError("listen");
+        }
+
+        return result;
+    }
+
+
+    //listens on a TCP port
+    Socket Socket::listenTcp(uint16_t port, bool loopback)
+    {
+        Socket result(::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!result.isValid())
+        {
+            _throwError("socket");
+        }
+
+        const int reuse = 1;
+        ::setsockopt(result.m_handle, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(loopback ? INADDR_LOOPBACK : INADDR_ANY);
+        address.sin_port = htons(port);
+        if (::bind(result.m_handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            _throwError("bind to port " + std::to_string(port));
+        }
+
+        if (::listen(result.m_handle, SOMAXCONN) != 0)
+        {
+            _throwError("listen");
+        }
+
+        return result;
+    }
+
+
+    //connects to a Unix domain socket
+    Socket Socket::connectUnix(const std::string &path)
+    {
+        Socket result(::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+        if (!result.isValid())
+        {
+            _throwError("socket");
+        }
+
+        const sockaddr_un address = _getUnixAddress(path);
+        if (::connect(result.m_handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            _throwError("connect to " + path);
+        }
+
+        return result;
+    }
+
+
+    //connects to a TCP socket
+    Socket Socket::connectTcp(const std::string &host, uint16_t port)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *addresses = nullptr;
+        const int error = ::getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses);
+        if (error != 0)
+        {
+            throw std::runtime_error("address of " + host + " not found: " + gai_strerror(error));
+        }
+
+        Socket result;
+        for (const addrinfo *address = addresses; address && !result.isValid(); address = address->ai_next)
+        {
+            result = Socket(::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol));
+            if (result.isValid() && ::connect(result.m_handle, address->ai_addr, address->ai_addrlen) != 0)
+            {
+                result.close();
+            }
+        }
+        ::freeaddrinfo(addresses);
+
+        if (!result.isValid())
+        {
+            _throwError("connect to " + host + ":" + std::to_string(port));
+        }
+
+        result.setNoDelay();
+        return result;
+    }
+
+
+    //returns the local port
+    uint16_t Socket::getPort() const
+    {
+        sockaddr_in address{};
+        socklen_t size = sizeof(address);
+        if (::getsockname(m_handle, reinterpret_cast<sockaddr *>(&address), &size) != 0)
+        {
+            _throwError("getsockname");
+        }
+        return ntohs(address.sin_port);
+    }
+
+
+    //accepts a connection
+    Socket Socket::accept() const
+    {
+        const int handle = ::accept4(m_handle, nullptr, nullptr, SOCK_CLOEXEC);
+        if (handle < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED)
+            {
+                return Socket();
+            }
+            _throwError("accept");
+        }
+        return Socket(handle);
+    }
+
+
+    //makes the socket non-blocking
+    void Socket::setNonBlocking()
+    {
+        const int flags = ::fcntl(m_handle, F_GETFL, 0);
+        if (flags < 0 || ::fcntl(m_handle, F_SETFL, flags | O_NONBLOCK) != 0)
+        {
+            _throwError("fcntl");
+        }
+    }
+
+
+    //disables the delay of small writes
+    void Socket::setNoDelay()
+    {
+        const int noDelay = 1;
+        ::setsockopt(m_handle, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    }
+
+
+    //reads data
+    ptrdiff_t Socket::read(void *buffer, size_t size)
+    {
+        for (;;)
+        {
+            const ssize_t result = ::recv(m_handle, buffer, size, 0);
+            if (result >= 0)
+            {
+                return result;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return WouldBlock;
+            }
+            if (errno == ECONNRESET)
+            {
+                return 0;
+            }
+            if (errno != EINTR)
+            {
+                _throwError("recv");
+            }
+        }
+    }
+
+
+    //writes data
+    ptrdiff_t Socket::write(const void *buffer, size_t size)
+    {
+        for (;;)
+        {
+            const ssize_t result = ::send(m_handle, buffer, size, MSG_NOSIGNAL);
+            if (result >= 0)
+            {
+                return result;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return WouldBlock;
+            }
+            if (errno != EINTR)
+            {
+                _throwError("send");
+            }
+        }
+    }
+
+
+    //closes the socket
+    void Socket::close()
+    {
+        if (m_handle >= 0)
+        {
+            ::close(m_handle);
+            m_handle = -1;
+        }
+    }
+
+
+#else
+
+
+    //sockets are not supported on this platform
+    static Socket _unsupported()
+    {
+        throw std::runtime_error("sockets are not supported on this platform");
+    }
+
+
+    Socket &Socket::operator = (Socket &&other)
+    {
+        std::swap(m_handle, other.m_handle);
+        return *this;
+    }
+
+
+    Socket Socket::listenUnix(const std::string &path)
+    {
+        return _unsupported();
+    }
+
+
+    Socket Socket::listenTcp(uint16_t port, bool loopback)
+    {
+        return _unsupported();
+    }
+
+
+    Socket Socket::connectUnix(const std::string &path)
+    {
+        return _unsupported();
+    }
+
+
+    Socket Socket::connectTcp(const std::string &host, uint16_t port)
+    {
+        return _unsupported();
+    }
+
+
+    uint16_t Socket::getPort() const
+    {
+        return 0;
+    }
+
+
+    Socket Socket::accept() const
+    {
+        return _unsupported();
+    }
+
+
+    void Socket::setNonBlocking()
+    {
+    }
+
+
+    void Socket::setNoDelay()
+    {
+    }
+
+
+    ptrdiff_t Socket::read(void *buffer, size_t size)
+    {
+        return 0;
+    }
+
+
+    ptrdiff_t Socket::write(const void *buffer, size_t size)
+    {
+        return 0;
+    }
+
+
+    void Socket::close()
+    {
+        m_handle = -1;
+    }
+
+
+#endif
+
+
+    //writes all the data
+    void Socket::writeAll(const void *buffer, size_t size)
+    {
+        const char *data = static_cast<const char *>(buffer);
+        while (size > 0)
+        {
+            const ptrdiff_t written = write(data, size);
+            if (written <= 0)
+            {
+                throw std::runtime_error("connection closed");
+            }
+            data += written;
+            size -= (size_t)written;
+        }
+    }
+
+
+    //reads a line
+    bool Socket::readLine(std::string &buffer, std::string &line)
+    {
+        for (;;)
+        {
+            const size_t end = buffer.find('\n');
+            if (end != std::string::npos)
+            {
+                line.assign(buffer, 0, end > 0 && buffer[end - 1] == '\r' ? end - 1 : end);
+                buffer.erase(0, end + 1);
+                return true;
+            }
+
+            char data[4096];
+            const ptrdiff_t size = read(data, sizeof(data));
+            if (size <= 0)
+            {
+                return false;
+            }
+            buffer.append(data, (size_t)size);
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,161 @@
+#ifndef LOTTERY_SOCKET_HPP
+#define LOTTERY_SOCKET_HPP
+
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Stream socket, over a Unix domain socket or TCP.
+        The socket is closed on destruction.
+        Sockets are only supported on POSIX systems;
+        elsewhere, creating a socket throws std::runtime_error.
+     */
+    class Socket
+    {
+    public:
+        ///result of read or write when the operation would block on a non-blocking socket.
+        static constexpr ptrdiff_t WouldBlock = -1;
+
+        ///invalid socket.
+        Socket()
+        {
+        }
+
+        ///takes ownership of a socket handle.
+        explicit Socket(int handle)
+            : m_handle(handle)
+        {
+        }
+
+        ///moves a socket.
+        Socket(Socket &&other)
+            : m_handle(other.m_handle)
+        {
+            other.m_handle = -1;
+        }
+
+        ///moves a socket.
+        Socket &operator = (Socket &&other);
+
+        Socket(const Socket &) = delete;
+        Socket &operator = (const Socket &) = delete;
+
+        ///closes the socket.
+        ~Socket()
+        {
+            close();
+        }
+
+        /**
+            Creates a Unix domain socket listening at the given path;
+            an existing socket at the path left by a previous server is removed first.
+            @exception std::runtime_error if there was an error, or the path exists and is not a socket,
+                or another server is listening on it.
+         */
+        static Socket listenUnix(const std::string &path);
+
+        /**
+            Creates a TCP socket listening on the given port.
+            @param port the port; if 0, a free port is chosen (see getPort).
+            @param loopback if true, only the loopback interface is listened on, otherwise all interfaces.
+            @exception std::runtime_error if there was an error.
+         */
+        static Socket listenTcp(uint16_t port, bool loopback = true);
+
+        /**
+            Connects to a Unix domain socket.
+            @exception std::runtime_error if there was an error.
+         */
+        static Socket connectUnix(const std::string &path);
+
+        /**
+            Connects to a TCP socket.
+            @param host host name or address.
+            @param port the port.
+            @exception std::runtime_error if there was an error.
+         */
+        static Socket connectTcp(const std::string &host, uint16_t port);
+
+        ///returns the handle of the socket.
+        int getHandle() const
+        {
+            return m_handle;
+        }
+
+        ///returns true if the socket is valid.
+        bool isValid() const
+        {
+            return m_handle >= 0;
+        }
+
+        ///returns the local port of a TCP socket.
+        uint16_t getPort() const;
+
+        /**
+            Accepts a connection of a listening socket.
+            @return the connection; invalid if the socket is non-blocking and there are no connections.
+            @exception std::runtime_error if there was an error.
+         */
+        Socket accept() const;
+
+        /**
+            Makes the operations of the socket non-blocking.
+            @exception std::runtime_error if there was an error.
+         */
+        void setNonBlocking();
+
+        /**
+            Disables the delay of small writes of TCP sockets; ignored for other sockets.
+         */
+        void setNoDelay();
+
+        /**
+            Reads data.
+            @return the number of bytes read, 0 if the connection was closed,
+                or WouldBlock if there is no data on a non-blocking socket.
+            @exception std::runtime_error if there was an error.
+         */
+        ptrdiff_t read(void *buffer, size_t size);
+
+        /**
+            Writes data.
+            @return the number of bytes written, or WouldBlock if a non-blocking socket cannot accept data.
+            @exception std::runtime_error if there was an error.
+         */
+        ptrdiff_t write(const void *buffer, size_t size);
+
+        /**
+            Writes all the data, on a blocking socket.
+            @exception std::runtime_error if there was an error.
+         */
+        void writeAll(const void *buffer, size_t size);
+
+        /**
+            Reads a line, without the new line, on a blocking socket.
+            Data after the line are kept in the given buffer for the next call.
+            @param buffer data read but not returned yet.
+            @param line the line.
+            @return false if the connection was closed before a line was read.
+            @exception std::runtime_error if there was an error.
+         */
+        bool readLine(std::string &buffer, std::string &line);
+
+        ///closes the socket.
+        void close();
+
+    private:
+        int m_handle = -1;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_SOCKET_HPP
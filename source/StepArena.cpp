@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include "StepArena.hpp"
+
+
+namespace Lottery
+{
+
+
+    //returns the position aligned to the given alignment
+    static char *_align(char *position, size_t alignment)
+    {
+        return (char *)(((uintptr_t)position + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    }
+
+
+    //frees the blocks
+    StepArena::~StepArena()
+    {
+        for (const Block &block : m_blocks)
+        {
+            #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+            MemoryTracker::deallocated(MemorySubsystem::Algorithm, block.end - block.begin);
+            #endif
+            ::operator delete(block.begin, std::align_val_t(CacheLineSize));
+        }
+    }
+
+
+    //allocates memory
+    void *StepArena::do_allocate(size_t bytes, size_t alignment)
+    {
+        //the blocks of the previous steps are used in order
+        for (; m_blockIndex < m_blocks.size(); ++m_blockIndex)
+        {
+            const Block &block = m_blocks[m_blockIndex];
+            if (!m_position)
+            {
+                m_position = block.begin;
+            }
+            char *const result = _align(m_position, alignment);
+            if (result <= block.end && (size_t)(block.end - result) >= bytes)
+            {
+                m_position = result + bytes;
+                return result;
+            }
+            m_position = nullptr;
+        }
+
+        //a new block; larger alignments are satisfied by aligning within the block
+        const size_t size = std::max(m_blockSize, bytes + (alignment > CacheLineSize ? alignment : 0));
+        char *const begin = (char *)::operator new(size, std::align_val_t(CacheLineSize));
+        #ifdef LOTTERY_ENABLE_MEMORY_TRACKING
+        MemoryTracker::allocated(MemorySubsystem::Algorithm, size);
+        #endif
+        m_blocks.push_back(Block{ begin, begin + size });
+        m_blockIndex = m_blocks.size() - 1;
+        char *const result = _align(begin, alignment);
+        m_position = result + bytes;
+        return result;
+    }
+
+
+} //namespace Lottery
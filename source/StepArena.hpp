@@ -0,0 +1,89 @@
+#ifndef LOTTERY_STEPARENA_HPP
+#define LOTTERY_STEPARENA_HPP
+
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+#include "MemoryTracker.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Memory for the temporary data of a step of a loop, i.e. of the predictions of a test draw.
+        Allocation advances a pointer in a block, and deallocation does nothing;
+        reset releases all the allocations at once, keeping the blocks,
+        so that once the blocks are large enough for a step, the steps do not allocate from the heap.
+        The blocks are recorded in the Algorithm subsystem of the memory tracker, if tracking is compiled in.
+        It is not thread-safe.
+     */
+    class StepArena : public std::pmr::memory_resource
+    {
+    public:
+        /**
+            Constructor.
+            @param blockSize size of the blocks; larger allocations get blocks of their own size.
+         */
+        StepArena(size_t blockSize = 1 << 16)
+            : m_blockSize(blockSize)
+        {
+        }
+
+        ///frees the blocks.
+        ~StepArena();
+
+        StepArena(const StepArena &) = delete;
+        StepArena &operator = (const StepArena &) = delete;
+
+        /**
+            Releases all the allocations, keeping the blocks.
+            Objects allocated from the arena must be destroyed before.
+         */
+        void reset()
+        {
+            m_blockIndex = 0;
+            m_position = m_blocks.empty() ? nullptr : m_blocks[0].begin;
+        }
+
+        ///returns the number of blocks.
+        size_t getBlockCount() const
+        {
+            return m_blocks.size();
+        }
+
+    protected:
+        ///allocates from the current block, or from the next one.
+        void *do_allocate(size_t bytes, size_t alignment) override;
+
+        ///does nothing; the memory is released by reset.
+        void do_deallocate(void *, size_t, size_t) override
+        {
+        }
+
+        ///arenas are equal only to themselves.
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+        {
+            return this == &other;
+        }
+
+    private:
+        struct Block
+        {
+            char *begin;
+            char *end;
+        };
+
+        size_t m_blockSize;
+        std::vector<Block> m_blocks;
+        size_t m_blockIndex = 0;
+        char *m_position = nullptr;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_STEPARENA_HPP
@@ -3,9 +3,16 @@
 
 
 #include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <stdexcept>
 #include "DrawVector.hpp"
 #include "calcAllColumnsCount.hpp"
 #include "NumberRange.hpp"
+#include "AlignedAllocator.hpp"
+#include "MemoryTracker.hpp"
+#include "FeatureStore.hpp"
 
 
 namespace Lottery
@@ -15,6 +22,30 @@ namespace Lottery
     class Game;
 
 
+    /**
+        Layout of the draws in memory.
+     */
+    enum class DrawLayout
+    {
+        ///draws as rows of numbers.
+        Rows,
+
+        ///draws as columns of numbers, one per position.
+        Columns,
+
+        ///both rows and columns.
+        Both
+    };
+
+
+    ///the numbers of a column of draws; aligned to a cache line, for vectorized kernels.
+    typedef std::vector<Number, SubsystemAllocator<Number, MemorySubsystem::Game, AlignedAllocator<Number>>> NumberColumn;
+
+
+    ///the columns of draws.
+    typedef std::vector<NumberColumn, SubsystemAllocator<NumberColumn, MemorySubsystem::Game>> NumberColumnVector;
+
+
     /**
         A lottery game may be split into two subgames,
         i.e. numbers 1 to 50 and numbers 1 to 20.
@@ -23,6 +54,46 @@ namespace Lottery
     class SubGame
     {
     public:
+        /**
+            Copy constructor.
+            It copies the layouts and the features built so far;
+            the rest are built on first access, as in the original.
+            It can be called while other threads read the original.
+         */
+        SubGame(const SubGame &subGame)
+            : m_name(subGame.m_name)
+            , m_index(subGame.m_index)
+            , m_minNumber(subGame.m_minNumber)
+            , m_maxNumber(subGame.m_maxNumber)
+            , m_numberCount(subGame.m_numberCount)
+            , m_numberSpan(subGame.m_numberSpan)
+            , m_drawsByColumn(subGame.m_numberCount)
+            , m_drawsCount(subGame.m_drawsCount)
+            , m_allDrawsCount(subGame.m_allDrawsCount)
+            , m_features(std::make_unique<FeatureStore>(*subGame.m_features))
+            , m_layout(std::make_unique<Layout>())
+        {
+            const DrawLayout layout = subGame._getLayout();
+            if (layout != DrawLayout::Columns)
+            {
+                m_draws = subGame.m_draws;
+                _chargeRows();
+            }
+            if (layout != DrawLayout::Rows)
+            {
+                m_drawsByColumn = subGame.m_drawsByColumn;
+            }
+            _setLayout(layout);
+        }
+
+        ///move constructor.
+        SubGame(SubGame &&subGame) = default;
+
+        SubGame &operator = (const SubGame &) = delete;
+
+        ///move assignment.
+        SubGame &operator = (SubGame &&subGame) = default;
+
         ///Returns the name of the subgame.
         const std::string &getName() const
         {
@@ -59,24 +130,89 @@ namespace Lottery
             return m_numberSpan;
         }
 
-        ///returns the draws of this subgame.
+        ///returns the number of draws.
+        size_t getDrawsCount() const
+        {
+            return m_drawsCount;
+        }
+
+        ///returns the draws of this subgame; if they were loaded by column only, they are built on first call.
         const DrawVector &getDraws() const
         {
+            std::call_once(m_layout->rows, [this]() { _buildRows(); m_layout->hasRows = true; });
             return m_draws;
         }
 
-        ///returns the draws by column.
-        const std::vector<std::vector<Number>> &getDrawsByColumn() const
+        ///returns the draws by column; if they were loaded by row only, they are built on first call.
+        const NumberColumnVector &getDrawsByColumn() const
         {
+            std::call_once(m_layout->columns, [this]() { _buildColumns(); m_layout->hasColumns = true; });
             return m_drawsByColumn;
         }
 
+        ///returns a number of a draw from the layout already built, without building the other layout.
+        Number getNumber(size_t drawIndex, size_t position) const
+        {
+            return m_layout->hasColumns ? m_drawsByColumn[position][drawIndex] : getDraws()[drawIndex][position];
+        }
+
         ///returns the number of all possible draws for this subgame.
         size_t getAllDrawsCount() const
         {
             return m_allDrawsCount;
         }
 
+        /**
+            Registers a custom per-draw feature, computed on first request.
+            @param name name of the feature.
+            @param func function which computes the feature.
+            @return the identifier of the feature.
+            @exception std::runtime_error if a feature with the same name exists.
+         */
+        size_t registerFeature(const std::string &name, const FeatureFunction &func) const
+        {
+            return m_features->registerFeature(name, func);
+        }
+
+        /**
+            Returns the identifier of a feature, built-in (see FeatureStore::BuiltinFeature) or custom.
+            @exception std::runtime_error if the feature does not exist.
+         */
+        size_t getFeatureId(const std::string &name) const
+        {
+            return m_features->getFeatureId(name);
+        }
+
+        /**
+            Returns the values of a feature for all the draws, computing them on first request.
+            The column is invalidated when draws are appended (Game::appendDraws).
+            @exception std::runtime_error if the feature does not exist.
+         */
+        const FeatureColumn &getFeature(size_t featureId) const
+        {
+            return m_features->getColumn(*this, featureId);
+        }
+
+        /**
+            Returns the value of a feature for a draw.
+            @exception std::runtime_error if the feature does not exist.
+         */
+        FeatureValue getFeature(size_t featureId, size_t drawIndex) const
+        {
+            return getFeature(featureId)[drawIndex];
+        }
+
+        /**
+            Returns the values of a feature for a range of draws.
+            The range is invalidated when draws are appended (Game::appendDraws).
+            @exception std::runtime_error if the feature does not exist.
+         */
+        FeatureRange getFeatureWindow(size_t featureId, size_t beginDrawIndex, size_t endDrawIndex) const
+        {
+            const FeatureColumn &column = getFeature(featureId);
+            return FeatureRange(column.begin() + beginDrawIndex, column.begin() + endDrawIndex);
+        }
+
     private:
         std::string m_name;
         size_t m_index;
@@ -84,9 +220,22 @@ namespace Lottery
         Number m_maxNumber;
         size_t m_numberCount;
         size_t m_numberSpan;
-        DrawVector m_draws;
-        std::vector<std::vector<Number>> m_drawsByColumn;
+        mutable DrawVector m_draws;
+        mutable MemoryCharge m_drawsMemory{ MemorySubsystem::Game };
+        mutable NumberColumnVector m_drawsByColumn;
+        size_t m_drawsCount = 0;
         size_t m_allDrawsCount;
+        std::unique_ptr<FeatureStore> m_features;
+
+        //the layouts that are built; held by pointer so that the subgame can be moved
+        struct Layout
+        {
+            std::once_flag rows;
+            std::once_flag columns;
+            std::atomic<bool> hasRows{ false };
+            std::atomic<bool> hasColumns{ false };
+        };
+        std::unique_ptr<Layout> m_layout;
 
         //constructor
         SubGame(
@@ -101,7 +250,98 @@ namespace Lottery
             , m_numberSpan(maxNumber - minNumber + 1)
             , m_drawsByColumn(numberCount)
             , m_allDrawsCount(calcAllColumnsCount(m_numberCount, m_maxNumber))
+            , m_features(std::make_unique<FeatureStore>())
+            , m_layout(std::make_unique<Layout>())
+        {
+        }
+
+        //marks the loaded layouts as built
+        void _setLayout(DrawLayout layout)
+        {
+            if (layout != DrawLayout::Columns)
+            {
+                std::call_once(m_layout->rows, [this]() { m_layout->hasRows = true; });
+            }
+            if (layout != DrawLayout::Rows)
+            {
+                std::call_once(m_layout->columns, [this]() { m_layout->hasColumns = true; });
+            }
+        }
+
+        //returns the layouts that are built
+        DrawLayout _getLayout() const
+        {
+            return !m_layout->hasColumns ? DrawLayout::Rows : !m_layout->hasRows ? DrawLayout::Columns : DrawLayout::Both;
+        }
+
+        //adds a draw in the given layout; the other layout, if not built, is built from it on first access
+        void _addDraw(const size_t *numbers, DrawLayout layout)
+        {
+            //check if the numbers are valid
+            for (size_t j = 0; j < m_numberCount; ++j)
+            {
+                if (numbers[j] < m_minNumber || numbers[j] > m_maxNumber)
+                {
+                    throw std::runtime_error("invalid number in draws file");
+                }
+            }
+
+            //store the numbers
+            if (layout != DrawLayout::Columns)
+            {
+                m_draws.emplace_back(m_numberCount);
+                for (size_t j = 0; j < m_numberCount; ++j)
+                {
+                    m_draws.back()[j] = (Number)numbers[j];
+                }
+                _chargeRows();
+            }
+
+            //store the numbers in the draws by column
+            if (layout != DrawLayout::Rows)
+            {
+                for (size_t j = 0; j < m_numberCount; ++j)
+                {
+                    m_drawsByColumn[j].push_back((Number)numbers[j]);
+                }
+            }
+
+            ++m_drawsCount;
+        }
+
+        //builds the rows from the columns
+        void _buildRows() const
+        {
+            m_draws.assign(m_drawsCount, Draw(m_numberCount));
+            for (size_t column = 0; column < m_numberCount; ++column)
+            {
+                const NumberColumn &numbers = m_drawsByColumn[column];
+                for (size_t i = 0; i < m_drawsCount; ++i)
+                {
+                    m_draws[i][column] = numbers[i];
+                }
+            }
+            _chargeRows();
+        }
+
+        //records the memory of the rows in the Game subsystem; the rows are of the fixed types passed to the algorithms
+        void _chargeRows() const
+        {
+            m_drawsMemory.setBytes(m_draws.capacity() * sizeof(Draw) + m_draws.size() * m_numberCount * sizeof(Number));
+        }
+
+        //builds the columns from the rows
+        void _buildColumns() const
         {
+            for (size_t column = 0; column < m_numberCount; ++column)
+            {
+                NumberColumn &numbers = m_drawsByColumn[column];
+                numbers.resize(m_drawsCount);
+                for (size_t i = 0; i < m_drawsCount; ++i)
+                {
+                    numbers[i] = m_draws[i][column];
+                }
+            }
         }
 
         friend class Game;
@@ -0,0 +1,156 @@
+#ifndef LOTTERY_SUCCESSTABLE_HPP
+#define LOTTERY_SUCCESSTABLE_HPP
+
+
+#include <vector>
+#include <algorithm>
+#include "AlignedAllocator.hpp"
+#include "MemoryTracker.hpp"
+#include "SubGame.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Counts of draws per count of numbers found, per algorithm and subgame.
+        The counters of each algorithm/subgame pair are stored contiguously,
+        starting at a cache line boundary.
+     */
+    class SuccessTable
+    {
+    public:
+        ///counter type.
+        typedef uint64_t Counter;
+
+        ///the default constructor.
+        SuccessTable()
+        {
+        }
+
+        /**
+            Constructor.
+            @param algorithmCount number of algorithms.
+            @param subGames subgames; each one has counters from 0 to its number count.
+         */
+        SuccessTable(size_t algorithmCount, const std::vector<SubGame> &subGames)
+            : m_algorithmCount(algorithmCount)
+        {
+            size_t offset = 0;
+            for (const SubGame &subGame : subGames)
+            {
+                m_counterCounts.push_back(subGame.getNumberCount() + 1);
+                m_offsets.push_back(offset);
+                offset += _roundToCacheLine(subGame.getNumberCount() + 1);
+            }
+            m_stride = offset;
+            m_counters.resize(m_stride * m_algorithmCount, 0);
+        }
+
+        ///returns the number of algorithms.
+        size_t getAlgorithmCount() const
+        {
+            return m_algorithmCount;
+        }
+
+        ///returns the number of subgames.
+        size_t getSubGameCount() const
+        {
+            return m_offsets.size();
+        }
+
+        ///returns the number of counters of a subgame.
+        size_t getCounterCount(size_t subGameIndex) const
+        {
+            return m_counterCounts[subGameIndex];
+        }
+
+        ///returns the counters of an algorithm/subgame pair.
+        Counter *getCounters(size_t algoIndex, size_t subGameIndex)
+        {
+            return m_counters.data() + algoIndex * m_stride + m_offsets[subGameIndex];
+        }
+
+        ///returns the counters of an algorithm/subgame pair.
+        const Counter *getCounters(size_t algoIndex, size_t subGameIndex) const
+        {
+            return m_counters.data() + algoIndex * m_stride + m_offsets[subGameIndex];
+        }
+
+        ///returns the count of draws for which the given count of numbers were found.
+        Counter getCount(size_t algoIndex, size_t subGameIndex, size_t numbersFound) const
+        {
+            return numbersFound < m_counterCounts[subGameIndex] ? getCounters(algoIndex, subGameIndex)[numbersFound] : 0;
+        }
+
+        ///adds a draw for which the given count of numbers were found.
+        void increment(size_t algoIndex, size_t subGameIndex, size_t numbersFound)
+        {
+            ++getCounters(algoIndex, subGameIndex)[numbersFound];
+        }
+
+        ///returns the counters of an algorithm/subgame pair as a vector.
+        std::vector<Counter> get(size_t algoIndex, size_t subGameIndex) const
+        {
+            const Counter *counters = getCounters(algoIndex, subGameIndex);
+            return std::vector<Counter>(counters, counters + m_counterCounts[subGameIndex]);
+        }
+
+        /**
+            Sets the counters of an algorithm/subgame pair.
+            @return false if the vector does not have the correct size.
+         */
+        bool set(size_t algoIndex, size_t subGameIndex, const std::vector<Counter> &counters)
+        {
+            if (counters.size() != m_counterCounts[subGameIndex])
+            {
+                return false;
+            }
+            std::copy(counters.begin(), counters.end(), getCounters(algoIndex, subGameIndex));
+            return true;
+        }
+
+        /**
+            Adds the counters of another table, i.e. of another range of test draws.
+            @return false if the tables do not have the same size.
+         */
+        bool add(const SuccessTable &other)
+        {
+            if (other.m_algorithmCount != m_algorithmCount || other.m_counterCounts != m_counterCounts)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < m_counters.size(); ++i)
+            {
+                m_counters[i] += other.m_counters[i];
+            }
+            return true;
+        }
+
+        ///compares the counters of two tables.
+        bool operator == (const SuccessTable &other) const
+        {
+            return m_counterCounts == other.m_counterCounts && m_counters == other.m_counters;
+        }
+
+    private:
+        size_t m_algorithmCount = 0;
+        size_t m_stride = 0;
+        std::vector<size_t> m_counterCounts;
+        std::vector<size_t> m_offsets;
+        std::vector<Counter, SubsystemAllocator<Counter, MemorySubsystem::Results, AlignedAllocator<Counter>>> m_counters;
+
+        //rounds a count of counters to a multiple of a cache line
+        static size_t _roundToCacheLine(size_t count)
+        {
+            const size_t countersPerLine = CacheLineSize / sizeof(Counter);
+            return (count + countersPerLine - 1) / countersPerLine * countersPerLine;
+        }
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_SUCCESSTABLE_HPP
@@ -0,0 +1,258 @@
+#include "TaskScheduler.hpp"
+
+
+namespace Lottery
+{
+
+
+    //the scheduler of the calling thread, if it is a thread of a scheduler, and the index of its queue
+    static thread_local TaskScheduler *_currentScheduler = nullptr;
+    static thread_local size_t _currentQueueIndex = 0;
+
+
+    //the group of the task the calling thread executes
+    static thread_local TaskGroup *_currentGroup = nullptr;
+
+
+    //constructor
+    TaskScheduler::TaskScheduler(size_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        m_queues.reset(new Queue[threadCount]);
+        for (size_t i = 0; i < threadCount; ++i)
+        {
+            m_threads.emplace_back([this, i]() { _run(i); });
+        }
+    }
+
+
+    //destructor
+    TaskScheduler::~TaskScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        for (std::thread &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+
+    //returns the shared scheduler
+    TaskScheduler &TaskScheduler::getDefault()
+    {
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+
+    //queues a task
+    void TaskScheduler::spawn(Task task)
+    {
+        Queue &queue = _currentScheduler == this ? m_queues[_currentQueueIndex] : m_sharedQueue;
+
+        //counted before it is queued, so that it is never taken before it is counted
+        ++m_pendingCount;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        //either the sleeping thread sees the pending count or this thread sees the sleeping count
+        if (m_sleepingCount > 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_condition.notify_one();
+        }
+    }
+
+
+    //executes a queued task
+    bool TaskScheduler::runTask()
+    {
+        Task task;
+        if (_takeTask(_currentScheduler == this ? _currentQueueIndex : m_threads.size(), task))
+        {
+            task();
+            return true;
+        }
+        return false;
+    }
+
+
+    //takes a task: the newest of the own queue, else the oldest of the shared queue or of the queue of another thread
+    bool TaskScheduler::_takeTask(size_t queueIndex, Task &task)
+    {
+        auto take = [&](Queue &queue, bool newest)
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty())
+            {
+                return false;
+            }
+            if (newest)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            --m_pendingCount;
+            return true;
+        };
+
+        if (m_pendingCount == 0)
+        {
+            return false;
+        }
+
+        const size_t threadCount = m_threads.size();
+        if (queueIndex < threadCount && take(m_queues[queueIndex], true))
+        {
+            return true;
+        }
+        if (take(m_sharedQueue, false))
+        {
+            return true;
+        }
+        for (size_t i = 1; i <= threadCount; ++i)
+        {
+            const size_t victimIndex = (queueIndex + i) % threadCount;
+            if (victimIndex != queueIndex && take(m_queues[victimIndex], false))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+
+    //thread function
+    void TaskScheduler::_run(size_t queueIndex)
+    {
+        _currentScheduler = this;
+        _currentQueueIndex = queueIndex;
+
+        for (;;)
+        {
+            Task task;
+            if (_takeTask(queueIndex, task))
+            {
+                task();
+                continue;
+            }
+
+            //sleep until there are tasks; stop when there are no tasks left
+            std::unique_lock<std::mutex> lock(m_mutex);
+            ++m_sleepingCount;
+            m_condition.wait(lock, [this]() { return m_stop || m_pendingCount > 0; });
+            --m_sleepingCount;
+            if (m_stop && m_pendingCount == 0)
+            {
+                return;
+            }
+        }
+    }
+
+
+    //constructor
+    TaskGroup::TaskGroup(TaskScheduler &scheduler)
+        : m_scheduler(scheduler)
+        , m_parent(_currentGroup)
+    {
+    }
+
+
+    //destructor
+    TaskGroup::~TaskGroup()
+    {
+        try
+        {
+            wait();
+        }
+        catch (...)
+        {
+        }
+    }
+
+
+    //returns the current group
+    TaskGroup *TaskGroup::getCurrent()
+    {
+        return _currentGroup;
+    }
+
+
+    //queues a task of the group
+    void TaskGroup::run(std::function<void()> func)
+    {
+        ++m_runningCount;
+        m_scheduler.spawn([this, func = std::move(func)]()
+        {
+            TaskGroup *const previousGroup = _currentGroup;
+            _currentGroup = this;
+            if (!isCancelled())
+            {
+                try
+                {
+                    func();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (!m_exception)
+                    {
+                        m_exception = std::current_exception();
+                    }
+                    cancel();
+                }
+            }
+            _currentGroup = previousGroup;
+
+            //the group may be destroyed as soon as the count is zero and the mutex is released
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_runningCount == 0)
+            {
+                m_condition.notify_all();
+            }
+        });
+    }
+
+
+    //waits for the tasks
+    void TaskGroup::wait()
+    {
+        while (m_runningCount > 0)
+        {
+            //execute queued tasks, of this group or others, instead of blocking a thread of the scheduler;
+            //if there are none, the tasks of the group run on other threads
+            if (m_scheduler.runTask())
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait_for(lock, std::chrono::milliseconds(1), [this]() { return m_runningCount == 0; });
+        }
+
+        std::exception_ptr exception;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::swap(exception, m_exception);
+        }
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+
+
+} //namespace Lottery
@@ -0,0 +1,295 @@
+#ifndef LOTTERY_TASKSCHEDULER_HPP
+#define LOTTERY_TASKSCHEDULER_HPP
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AlignedAllocator.hpp"
+
+
+namespace Lottery
+{
+
+
+    /**
+        Fixed set of threads that execute tasks, with a task queue per thread.
+        A thread executes the tasks of its own queue newest first, so that nested tasks
+        run while their data are in the cache; when its queue is empty, it takes
+        the oldest task of the shared queue or of the queues of other threads (work stealing).
+        Tasks submitted from other threads go to the shared queue, in order of submission.
+
+        One scheduler is meant to be shared by the backtests, enumerations and loading of a process,
+        so that nested parallel loops do not create more threads than cores.
+     */
+    class TaskScheduler
+    {
+    public:
+        ///a task.
+        typedef std::function<void()> Task;
+
+        /**
+            Constructor.
+            @param threadCount number of threads; if 0, the number of hardware threads is used.
+         */
+        TaskScheduler(size_t threadCount = 0);
+
+        ///waits for the queued tasks to complete and stops the threads.
+        ~TaskScheduler();
+
+        TaskScheduler(const TaskScheduler &) = delete;
+        TaskScheduler &operator = (const TaskScheduler &) = delete;
+
+        ///returns the scheduler shared by the process, with one thread per hardware thread.
+        static TaskScheduler &getDefault();
+
+        ///returns the number of threads.
+        size_t getThreadCount() const
+        {
+            return m_threads.size();
+        }
+
+        /**
+            Queues a task; from a thread of the scheduler, into the queue of that thread,
+            otherwise into the shared queue. The task must not throw.
+         */
+        void spawn(Task task);
+
+        /**
+            Executes a queued task on the calling thread, if there is one;
+            used by threads that wait for tasks to complete.
+            @return true if a task was executed.
+         */
+        bool runTask();
+
+        /**
+            Queues a task.
+            @param func function to execute.
+            @return future for the result of the function; exceptions are passed to the future.
+         */
+        template <class F> auto submit(F &&func) -> std::future<decltype(func())>
+        {
+            typedef decltype(func()) Result;
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+            std::future<Result> result = task->get_future();
+            spawn([task]() { (*task)(); });
+            return result;
+        }
+
+    private:
+        //a task queue, on its own cache line
+        struct alignas(CacheLineSize) Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::thread> m_threads;
+        std::unique_ptr<Queue[]> m_queues;
+        Queue m_sharedQueue;
+        std::atomic<size_t> m_pendingCount{ 0 };
+        std::atomic<size_t> m_sleepingCount{ 0 };
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stop = false;
+
+        //takes a task for the given thread; its queue index, or the thread count for other threads
+        bool _takeTask(size_t queueIndex, Task &task);
+
+        //thread function
+        void _run(size_t queueIndex);
+    };
+
+
+    /**
+        A group of tasks that can be waited for and cancelled together.
+        The thread that waits executes queued tasks meanwhile, so that groups can be nested
+        within tasks of other groups without blocking threads of the scheduler.
+        A group created within a task of another group is cancelled when that group is cancelled.
+        If a task throws, the group is cancelled, and wait rethrows the first exception.
+     */
+    class TaskGroup
+    {
+    public:
+        /**
+            Constructor.
+            @param scheduler the scheduler to run the tasks on.
+         */
+        TaskGroup(TaskScheduler &scheduler = TaskScheduler::getDefault());
+
+        ///waits for the tasks.
+        ~TaskGroup();
+
+        TaskGroup(const TaskGroup &) = delete;
+        TaskGroup &operator = (const TaskGroup &) = delete;
+
+        ///returns the group of the task the calling thread executes, or null.
+        static TaskGroup *getCurrent();
+
+        ///queues a task of the group.
+        void run(std::function<void()> func);
+
+        /**
+            Waits for the tasks of the group to complete.
+            @exception the first exception thrown by a task.
+         */
+        void wait();
+
+        ///cancels the tasks of the group that have not started; started tasks may check isCancelled.
+        void cancel()
+        {
+            m_cancelled.store(true, std::memory_order_relaxed);
+        }
+
+        ///tells if the group or a group it is nested in is cancelled.
+        bool isCancelled() const
+        {
+            for (const TaskGroup *group = this; group; group = group->m_parent)
+            {
+                if (group->m_cancelled.load(std::memory_order_relaxed))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        TaskScheduler &m_scheduler;
+        TaskGroup *m_parent;
+        std::atomic<size_t> m_runningCount{ 0 };
+        std::atomic<bool> m_cancelled{ false };
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        std::exception_ptr m_exception;
+    };
+
+
+    //splits a range in halves, queueing the upper halves, until the ranges are not greater than the grain size
+    template <class F>
+    void _parallelFor(TaskGroup &group, size_t begin, size_t end, size_t grainSize, const F &func)
+    {
+        while (end - begin > grainSize && !group.isCancelled())
+        {
+            const size_t middle = begin + (end - begin) / 2;
+            group.run([&group, middle, end, grainSize, &func]() { _parallelFor(group, middle, end, grainSize, func); });
+            end = middle;
+        }
+        if (!group.isCancelled() && !func(begin, end))
+        {
+            group.cancel();
+        }
+    }
+
+
+    /**
+        Calls a function for subranges of a range of indexes (i.e. draw indexes) in parallel.
+        The range is split recursively, so that idle threads steal large subranges.
+        @param scheduler the scheduler.
+        @param begin begin of the range.
+        @param end end of the range.
+        @param grainSize maximum size of the subranges.
+        @param func function with the begin and end of a subrange as parameters;
+            it returns false to cancel the subranges that have not started.
+        @return false if cancelled.
+        @exception the first exception thrown by the function.
+     */
+    template <class F>
+    bool parallelFor(TaskScheduler &scheduler, size_t begin, size_t end, size_t grainSize, const F &func)
+    {
+        if (begin >= end)
+        {
+            return true;
+        }
+        TaskGroup group(scheduler);
+        try
+        {
+            _parallelFor(group, begin, end, std::max<size_t>(grainSize, 1), func);
+        }
+        catch (...)
+        {
+            group.cancel();
+            throw;
+        }
+        group.wait();
+        return !group.isCancelled();
+    }
+
+
+    /**
+        Computes a value for subranges of a range of indexes in parallel, and combines the values.
+        The subranges are aligned to the grain size, and the values are combined in order of subrange,
+        so that the result does not depend on the scheduling, even for floating point values.
+        @param scheduler the scheduler.
+        @param begin begin of the range.
+        @param end end of the range.
+        @param grainSize size of the subranges.
+        @param identity result for an empty range.
+        @param map function with the begin and end of a subrange as parameters, returning its value.
+        @param reduce function that combines two values.
+        @return the combined value.
+        @exception the first exception thrown by the functions.
+     */
+    template <class T, class Map, class Reduce>
+    T parallelReduce(TaskScheduler &scheduler, size_t begin, size_t end, size_t grainSize, T identity, const Map &map, const Reduce &reduce)
+    {
+        if (begin >= end)
+        {
+            return identity;
+        }
+        grainSize = std::max<size_t>(grainSize, 1);
+        std::vector<T> values((end - begin + grainSize - 1) / grainSize, identity);
+        parallelFor(scheduler, 0, values.size(), 1, [&](size_t valueBegin, size_t valueEnd)
+        {
+            for (size_t i = valueBegin; i < valueEnd; ++i)
+            {
+                values[i] = map(begin + i * grainSize, std::min(begin + (i + 1) * grainSize, end));
+            }
+            return true;
+        });
+        T result = std::move(identity);
+        for (T &value : values)
+        {
+            result = reduce(std::move(result), std::move(value));
+        }
+        return result;
+    }
+
+
+    /**
+        Calls a function for each element of a container (i.e. a list of algorithms) in parallel.
+        @param scheduler the scheduler.
+        @param container the container; it must have random access.
+        @param func function with an element as parameter; it returns false to cancel the elements that have not started.
+        @return false if cancelled.
+        @exception the first exception thrown by the function.
+     */
+    template <class C, class F>
+    bool parallelForEach(TaskScheduler &scheduler, C &container, const F &func)
+    {
+        return parallelFor(scheduler, 0, container.size(), 1, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!func(container[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_TASKSCHEDULER_HPP
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <bitset>
+#include "TicketScorer.hpp"
+#include "TaskScheduler.hpp"
+
+
+namespace Lottery
+{
+
+
+    //number of draws scored against all the tickets of a batch before the next draws; 16 KB of masks
+    static constexpr size_t DrawBlockSize = 512;
+
+
+    //number of draws above which the draws are scored in parallel; a multiple of the block size
+    static constexpr size_t ParallelDrawCount = 64 * DrawBlockSize;
+
+
+    //returns the count of bits set
+    static unsigned _popCount(uint64_t value)
+    {
+        #if defined(__POPCNT__) || (defined(_MSC_VER) && defined(__AVX__))
+        return (unsigned)std::bitset<64>(value).count();
+        #else
+        //without the popcnt instruction, count in parallel within the word
+        value = value - ((value >> 1) & 0x5555555555555555ull);
+        value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+        value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0full;
+        return (unsigned)((value * 0x0101010101010101ull) >> 56);
+        #endif
+    }
+
+
+    //scores the tickets against a block of draws, for masks of the given number of words;
+    //four tickets are scored per pass over the draws, into separate histograms,
+    //so that the increments of the histograms do not depend on each other
+    template <size_t WordCount>
+    static void _scoreBlock(const NumberMask *draws, size_t drawCount, const NumberMask *tickets, size_t ticketCount, size_t resultSize, uint32_t *results)
+    {
+        auto countHits = [&](const NumberMask &draw, const NumberMask &ticket)
+        {
+            unsigned hits = 0;
+            for (size_t word = 0; word < WordCount; ++word)
+            {
+                hits += _popCount(draw[word] & ticket[word]);
+            }
+            return hits;
+        };
+
+        size_t ticketIndex = 0;
+        for (; ticketIndex + 4 <= ticketCount; ticketIndex += 4)
+        {
+            uint32_t *ticketResults = results + ticketIndex * resultSize;
+            for (size_t drawIndex = 0; drawIndex < drawCount; ++drawIndex)
+            {
+                const NumberMask &draw = draws[drawIndex];
+                ++ticketResults[countHits(draw, tickets[ticketIndex])];
+                ++ticketResults[resultSize + countHits(draw, tickets[ticketIndex + 1])];
+                ++ticketResults[2 * resultSize + countHits(draw, tickets[ticketIndex + 2])];
+                ++ticketResults[3 * resultSize + countHits(draw, tickets[ticketIndex + 3])];
+            }
+        }
+
+        for (; ticketIndex < ticketCount; ++ticketIndex)
+        {
+            uint32_t *ticketResults = results + ticketIndex * resultSize;
+            for (size_t drawIndex = 0; drawIndex < drawCount; ++drawIndex)
+            {
+                ++ticketResults[countHits(draws[drawIndex], tickets[ticketIndex])];
+            }
+        }
+    }
+
+
+    //constructor
+    TicketScorer::TicketScorer(const SubGame &subGame)
+        : m_subGame(subGame)
+        , m_wordCount(subGame.getMaxNumber() / 64 + 1)
+    {
+        update();
+    }
+
+
+    //adds the new draws
+    void TicketScorer::update()
+    {
+        const size_t begin = m_draws.size();
+        const size_t end = m_subGame.getDrawsCount();
+        m_draws.resize(end, NumberMask{});
+        for (const NumberColumn &column : m_subGame.getDrawsByColumn())
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                m_draws[i][column[i] >> 6] |= 1ull << (column[i] & 63);
+            }
+        }
+    }
+
+
+    //scores the tickets against a range of draws, adding to the results
+    void TicketScorer::_score(size_t beginDrawIndex, size_t endDrawIndex, const NumberMask *tickets, size_t ticketCount, uint32_t *results) const
+    {
+        const size_t resultSize = getResultSize();
+        for (size_t begin = beginDrawIndex; begin < endDrawIndex; begin += DrawBlockSize)
+        {
+            const size_t drawCount = std::min(DrawBlockSize, endDrawIndex - begin);
+            switch (m_wordCount)
+            {
+                case 1:
+                    _scoreBlock<1>(m_draws.data() + begin, drawCount, tickets, ticketCount, resultSize, results);
+                    break;
+
+                case 2:
+                    _scoreBlock<2>(m_draws.data() + begin, drawCount, tickets, ticketCount, resultSize, results);
+                    break;
+
+                default:
+                    _scoreBlock<4>(m_draws.data() + begin, drawCount, tickets, ticketCount, resultSize, results);
+                    break;
+            }
+        }
+    }
+
+
+    //scores tickets
+    void TicketScorer::score(const NumberMask *tickets, size_t ticketCount, uint32_t *results) const
+    {
+        const size_t resultCount = ticketCount * getResultSize();
+        std::fill(results, results + resultCount, 0);
+
+        if (m_draws.size() <= ParallelDrawCount)
+        {
+            _score(0, m_draws.size(), tickets, ticketCount, results);
+            return;
+        }
+
+        //long histories are split into ranges of draws, scored in parallel, and their counts added
+        const std::vector<uint32_t> counts = parallelReduce(TaskScheduler::getDefault(), 0, m_draws.size(), ParallelDrawCount, std::vector<uint32_t>(),
+            [&](size_t begin, size_t end)
+            {
+                std::vector<uint32_t> counts(resultCount);
+                _score(begin, end, tickets, ticketCount, counts.data());
+                return counts;
+            },
+            [](std::vector<uint32_t> &&counts, std::vector<uint32_t> &&rangeCounts)
+            {
+                if (counts.empty())
+                {
+                    return std::move(rangeCounts);
+                }
+                for (size_t i = 0; i < counts.size(); ++i)
+                {
+                    counts[i] += rangeCounts[i];
+                }
+                return std::move(counts);
+            });
+        std::copy(counts.begin(), counts.end(), results);
+    }
+
+
+} //namespace Lottery
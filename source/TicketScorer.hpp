@@ -0,0 +1,93 @@
+#ifndef LOTTERY_TICKETSCORER_HPP
+#define LOTTERY_TICKETSCORER_HPP
+
+
+#include <array>
+#include <vector>
+#include "SubGame.hpp"
+
+
+namespace Lottery
+{
+
+
+    ///set of numbers, one bit per number; numbers are 8 bits, so 256 bits.
+    typedef std::array<uint64_t, 4> NumberMask;
+
+
+    /**
+        Scores tickets against the draws of a subgame:
+        for each ticket, it counts the draws by the count of numbers of the ticket they contain.
+        The draws are kept as number masks, so that a ticket is compared
+        to a draw with a few and/popcount operations; tickets are scored in batches,
+        with the draws processed in blocks that stay in the cache for all the tickets of a batch.
+     */
+    class TicketScorer
+    {
+    public:
+        /**
+            Constructor.
+            @param subGame the subgame to score tickets against.
+         */
+        TicketScorer(const SubGame &subGame);
+
+        ///returns the subgame.
+        const SubGame &getSubGame() const
+        {
+            return m_subGame;
+        }
+
+        ///returns the number of draws scored against.
+        size_t getDrawsCount() const
+        {
+            return m_draws.size();
+        }
+
+        ///returns the number of results per ticket; the number count of the subgame + 1.
+        size_t getResultSize() const
+        {
+            return m_subGame.getNumberCount() + 1;
+        }
+
+        ///adds the draws appended to the subgame since construction or the last update.
+        void update();
+
+        /**
+            Creates the mask of a set of numbers.
+            @param begin begin of the numbers.
+            @param end end of the numbers.
+         */
+        template <class It> static NumberMask createMask(It begin, It end)
+        {
+            NumberMask result{};
+            for (; begin != end; ++begin)
+            {
+                result[(Number)*begin >> 6] |= 1ull << ((Number)*begin & 63);
+            }
+            return result;
+        }
+
+        /**
+            Scores a batch of tickets.
+            Long histories are scored in parallel on the default task scheduler.
+            @param tickets the tickets.
+            @param ticketCount number of tickets.
+            @param results getResultSize() counts per ticket;
+                the count at index i is the number of draws which contain i numbers of the ticket.
+         */
+        void score(const NumberMask *tickets, size_t ticketCount, uint32_t *results) const;
+
+    private:
+        const SubGame &m_subGame;
+        size_t m_wordCount;
+        std::vector<NumberMask> m_draws;
+
+        //scores the tickets against a range of draws, adding to the results
+        void _score(size_t beginDrawIndex, size_t endDrawIndex, const NumberMask *tickets, size_t ticketCount, uint32_t *results) const;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_TICKETSCORER_HPP
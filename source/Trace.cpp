@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <stdexcept>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <unordered_set>
+#include "Trace.hpp"
+#include "parseNumber.hpp"
+
+
+namespace Lottery
+{
+
+
+    //event
+    struct TraceEvent
+    {
+        const char *name;
+        const char *detail;
+        uint64_t startTime;
+        uint64_t duration;
+        int64_t arg0;
+        int64_t arg1;
+    };
+
+
+    //ring buffer of a thread's events; written only by its thread, allocated by chunks as it fills
+    struct TraceThread
+    {
+        size_t id;
+        size_t capacity = Trace::getThreadCapacity();
+        std::unique_ptr<std::unique_ptr<TraceEvent[]>[]> chunks{ new std::unique_ptr<TraceEvent[]>[capacity / Trace::ChunkCapacity] };
+        std::atomic<uint64_t> count{ 0 };
+
+        //returns the event at the given position; its chunk must be allocated
+        TraceEvent &getEvent(uint64_t index) const
+        {
+            const size_t position = (size_t)(index % capacity);
+            return chunks[position / Trace::ChunkCapacity][position % Trace::ChunkCapacity];
+        }
+    };
+
+
+    //global state
+    static std::mutex _mutex;
+    static std::string _filename;
+    static std::vector<TraceThread *> _threads;
+    static std::unordered_set<std::string> _strings;
+
+
+    //the events of the current thread
+    static thread_local TraceThread *_thread = nullptr;
+
+
+    //writes a JSON string
+    static void _writeString(std::ostream &stream, const char *str)
+    {
+        stream << '"';
+        for (; *str; ++str)
+        {
+            if (*str == '"' || *str == '\\')
+            {
+                stream << '\\';
+            }
+            stream << *str;
+        }
+        stream << '"';
+    }
+
+
+    //stops at exit
+    static void _stopAtExit()
+    {
+        try
+        {
+            Trace::stop();
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+    }
+
+
+    //rounds a capacity up to whole chunks
+    static size_t _roundCapacity(size_t capacity)
+    {
+        return capacity ? (capacity + Trace::ChunkCapacity - 1) / Trace::ChunkCapacity * Trace::ChunkCapacity : Trace::DefaultThreadCapacity;
+    }
+
+
+    //returns the capacity set by the environment variable LOTTERY_TRACE_CAPACITY; the default if it is not a number
+    static size_t _getCapacityFromEnvironment()
+    {
+        const char *value = std::getenv("LOTTERY_TRACE_CAPACITY");
+        try
+        {
+            return value ? _roundCapacity(parseNumber(value, "trace capacity", SIZE_MAX / 2)) : Trace::DefaultThreadCapacity;
+        }
+        catch (const std::runtime_error &)
+        {
+            return Trace::DefaultThreadCapacity;
+        }
+    }
+
+
+    //starts recording if the environment variable LOTTERY_TRACE is set
+    static bool _startFromEnvironment()
+    {
+        const char *filename = std::getenv("LOTTERY_TRACE");
+        if (!filename || !*filename)
+        {
+            return false;
+        }
+        _filename = filename;
+        std::atexit(&_stopAtExit);
+        return true;
+    }
+
+
+    std::atomic<bool> Trace::m_enabled{ _startFromEnvironment() };
+    std::atomic<size_t> Trace::m_threadCapacity{ _getCapacityFromEnvironment() };
+
+
+    //sets the capacity of the threads created afterwards
+    void Trace::setThreadCapacity(size_t capacity)
+    {
+        m_threadCapacity = _roundCapacity(capacity);
+    }
+
+
+    //starts recording
+    void Trace::start(const std::string &filename)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_filename.empty())
+        {
+            std::atexit(&_stopAtExit);
+        }
+        _filename = filename;
+        m_enabled = true;
+    }
+
+
+    //stops recording and writes the events
+    void Trace::stop()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!m_enabled)
+        {
+            return;
+        }
+        m_enabled = false;
+
+        std::ofstream file(_filename);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("the trace file could not be opened for writing");
+        }
+
+        //timestamps are in microseconds, with nanosecond precision
+        file << std::fixed << std::setprecision(3);
+
+        file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+        //find the first timestamp, so that the timeline starts at 0
+        uint64_t baseTime = UINT64_MAX;
+        for (const TraceThread *thread : _threads)
+        {
+            const uint64_t count = thread->count.load(std::memory_order_acquire);
+            const uint64_t first = count > thread->capacity ? count - thread->capacity : 0;
+            for (uint64_t i = first; i < count; ++i)
+            {
+                baseTime = std::min(baseTime, thread->getEvent(i).startTime);
+            }
+        }
+
+        bool first = true;
+        for (const TraceThread *thread : _threads)
+        {
+            //thread name
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id
+                 << ",\"args\":{\"name\":\"Thread " << thread->id << "\"}}";
+            first = false;
+
+            //the events still in the ring buffer, oldest first
+            const uint64_t count = thread->count.load(std::memory_order_acquire);
+            for (uint64_t i = count > thread->capacity ? count - thread->capacity : 0; i < count; ++i)
+            {
+                const TraceEvent &event = thread->getEvent(i);
+                file << ",\n{\"name\":";
+                _writeString(file, event.name);
+                file << ",\"cat\":\"lottery\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread->id
+                     << ",\"ts\":" << (event.startTime - baseTime) / 1000.0
+                     << ",\"dur\":" << event.duration / 1000.0;
+                if (event.detail)
+                {
+                    file << ",\"args\":{\"detail\":";
+                    _writeString(file, event.detail);
+                    file << ",\"arg0\":" << event.arg0 << ",\"arg1\":" << event.arg1 << '}';
+                }
+                file << '}';
+            }
+        }
+
+        file << "\n]}\n";
+
+        if (!file.good())
+        {
+            throw std::runtime_error("the trace file could not be written");
+        }
+    }
+
+
+    //interns a string
+    const char *Trace::intern(const std::string &str)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _strings.insert(str).first->c_str();
+    }
+
+
+    //records an event
+    void Trace::record(const char *name, uint64_t startTime, uint64_t duration, const char *detail, int64_t arg0, int64_t arg1)
+    {
+        if (!_thread)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _thread = new TraceThread;
+            _thread->id = _threads.size() + 1;
+            _threads.push_back(_thread);
+        }
+
+        //the chunk is allocated when the first pass over the ring reaches it; the release of the count publishes it
+        const uint64_t index = _thread->count.load(std::memory_order_relaxed);
+        if (index < _thread->capacity && index % ChunkCapacity == 0)
+        {
+            _thread->chunks[index / ChunkCapacity].reset(new TraceEvent[ChunkCapacity]);
+        }
+        _thread->getEvent(index) = TraceEvent{ name, detail, startTime, duration, arg0, arg1 };
+        _thread->count.store(index + 1, std::memory_order_release);
+    }
+
+
+} //namespace Lottery
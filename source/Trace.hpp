@@ -0,0 +1,100 @@
+#ifndef LOTTERY_TRACE_HPP
+#define LOTTERY_TRACE_HPP
+
+
+#include <atomic>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Records profiled scopes as timeline events and writes them
+        in Chrome trace-event JSON format, which can be opened in
+        chrome://tracing or the Perfetto UI.
+
+        Each thread records into its own ring buffer, without locking;
+        when a buffer is full, the oldest events are overwritten.
+        The buffers are allocated in chunks as the events are recorded,
+        so threads which record few events use little memory.
+        The buffers are written when the trace is stopped, or at exit.
+     */
+    class Trace
+    {
+    public:
+        ///default number of events kept per thread; about 12 MB per thread once full.
+        static constexpr size_t DefaultThreadCapacity = 1 << 18;
+
+        ///number of events allocated at once; the capacity is a multiple of it.
+        static constexpr size_t ChunkCapacity = 1 << 12;
+
+        /**
+            Returns the number of events kept per thread.
+            It is DefaultThreadCapacity, unless set by setThreadCapacity
+            or by the environment variable LOTTERY_TRACE_CAPACITY.
+         */
+        static size_t getThreadCapacity()
+        {
+            return m_threadCapacity.load(std::memory_order_relaxed);
+        }
+
+        /**
+            Sets the number of events kept per thread, rounded up to a multiple of ChunkCapacity.
+            It applies to the threads which record their first event afterwards.
+            @param capacity number of events; 0 for the default.
+         */
+        static void setThreadCapacity(size_t capacity);
+
+        /**
+            Starts recording.
+            Recording also starts automatically at program start
+            if the environment variable LOTTERY_TRACE is set to a filename;
+            LOTTERY_TRACE_CAPACITY may set the number of events kept per thread.
+            @param filename name of the file to write the events to.
+         */
+        static void start(const std::string &filename);
+
+        /**
+            Stops recording and writes the events of all threads to the file.
+            It is called automatically at exit.
+            @exception std::runtime_error if the file could not be written.
+         */
+        static void stop();
+
+        ///tells if recording is enabled.
+        static bool isEnabled()
+        {
+            return m_enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+            Returns a copy of the given string that remains valid until the end of the program,
+            so that it can be passed as detail of events.
+         */
+        static const char *intern(const std::string &str);
+
+        /**
+            Records an event of the current thread; it must be called only if recording is enabled.
+            @param name name of the event; it must remain valid until the end of the program.
+            @param startTime start time, in nanoseconds.
+            @param duration duration, in nanoseconds.
+            @param detail optional detail; it must remain valid until the end of the program.
+            @param arg0 first argument; ignored if detail is null.
+            @param arg1 second argument; ignored if detail is null.
+         */
+        static void record(const char *name, uint64_t startTime, uint64_t duration, const char *detail = nullptr, int64_t arg0 = 0, int64_t arg1 = 0);
+
+    private:
+        static std::atomic<bool> m_enabled;
+        static std::atomic<size_t> m_threadCapacity;
+    };
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_TRACE_HPP
@@ -3,15 +3,16 @@
 
 
 #include <vector>
+#include "MemoryTracker.hpp"
 
 
 namespace Lottery
 {
 
 
-    template <class T, class F> 
+    template <class T, class Alloc, class F> 
     bool createPermutationsHelper(
-        std::vector<T> &result, 
+        std::vector<T, Alloc> &result, 
         const size_t resultPosition,
         const F &func)
     {
@@ -53,9 +54,7 @@ namespace Lottery
     template <class Symbols, class F> 
     bool createPermutations(const Symbols &symbols, const F &func)
     {
-        std::vector<typename Symbols::value_type> result;
-        result.clear();
-        result.insert(result.end(), symbols.begin(), symbols.end());
+        std::vector<typename Symbols::value_type, SubsystemAllocator<typename Symbols::value_type, MemorySubsystem::Enumeration>> result(symbols.begin(), symbols.end());
         return createPermutationsHelper(result, 0, func);
     }
 
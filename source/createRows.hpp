@@ -2,13 +2,18 @@
 #define LOTTERY_CREATEROWS_HPP
 
 
+#include <vector>
+#include "MemoryTracker.hpp"
+#include "TaskScheduler.hpp"
+
+
 namespace Lottery
 {
 
 
     //helper function
-    template <class T, class F>
-    bool createRowsHelper(const std::vector<T> &values, const size_t rowLength, const F &func, const size_t rowIndex, const size_t valueIndex, std::vector<T> &result)
+    template <class T, class Alloc, class F>
+    bool createRowsHelper(const std::vector<T, Alloc> &values, const size_t rowLength, const F &func, const size_t rowIndex, const size_t valueIndex, std::vector<T, Alloc> &result)
     {
         if (rowIndex == rowLength) return func(result);
         for (size_t vi = valueIndex; vi < values.size() - rowLength + rowIndex + 1; ++vi)
@@ -23,10 +28,10 @@ namespace Lottery
     /**
         Creates all possible rows.
      */
-    template <class T, class F>
-    bool createRows(const std::vector<T> &values, const size_t rowLength, const F &func)
+    template <class T, class Alloc, class F>
+    bool createRows(const std::vector<T, Alloc> &values, const size_t rowLength, const F &func)
     {
-        std::vector<T> result(rowLength);
+        std::vector<T, Alloc> result(rowLength);
         return createRowsHelper(values, rowLength, func, 0, 0, result);
     }
 
@@ -37,12 +42,87 @@ namespace Lottery
     template <class T, class F>
     bool createRows(const T minNumber, const T maxNumber, const size_t rowLength, const F &func)
     {
-        std::vector<T> values;
+        std::vector<T, SubsystemAllocator<T, MemorySubsystem::Enumeration>> values;
         for (T num = minNumber; num <= maxNumber; ++num) { values.push_back(num); }
         return createRows(values, rowLength, func);
     }
 
 
+    /**
+        Returns the count of rows of the given length that can be created from the given count of values.
+     */
+    inline size_t getRowCount(size_t valueCount, size_t rowLength)
+    {
+        if (rowLength > valueCount) return 0;
+        size_t result = 1;
+        for (size_t i = 0; i < rowLength; ++i)
+        {
+            result = result * (valueCount - i) / (i + 1);
+        }
+        return result;
+    }
+
+
+    /**
+        Creates the rows with ranks from beginRank up to endRank,
+        the rank of a row being its position in the order createRows creates the rows in.
+        The first row is computed from its rank, so that the rows can be split into ranges.
+     */
+    template <class T, class Alloc, class F>
+    bool createRows(const std::vector<T, Alloc> &values, const size_t rowLength, const size_t beginRank, size_t endRank, const F &func)
+    {
+        const size_t valueCount = values.size();
+        endRank = std::min(endRank, getRowCount(valueCount, rowLength));
+        if (beginRank >= endRank) return true;
+
+        //the value indexes of the first row; each value is skipped along with the rows that start with it
+        std::vector<size_t, SubsystemAllocator<size_t, MemorySubsystem::Enumeration>> indexes(rowLength);
+        size_t rank = beginRank;
+        for (size_t rowIndex = 0, vi = 0; rowIndex < rowLength; ++rowIndex, ++vi)
+        {
+            for (size_t count; rank >= (count = getRowCount(valueCount - vi - 1, rowLength - rowIndex - 1)); ++vi)
+            {
+                rank -= count;
+            }
+            indexes[rowIndex] = vi;
+        }
+
+        std::vector<T, Alloc> result(rowLength);
+        for (rank = beginRank;;)
+        {
+            for (size_t rowIndex = 0; rowIndex < rowLength; ++rowIndex)
+            {
+                result[rowIndex] = values[indexes[rowIndex]];
+            }
+            if (!func(result)) return false;
+            if (++rank == endRank) return true;
+
+            //the next row: increment the last index that can be incremented, and reset the indexes after it
+            size_t rowIndex = rowLength - 1;
+            while (indexes[rowIndex] == valueCount - rowLength + rowIndex) --rowIndex;
+            ++indexes[rowIndex];
+            for (++rowIndex; rowIndex < rowLength; ++rowIndex)
+            {
+                indexes[rowIndex] = indexes[rowIndex - 1] + 1;
+            }
+        }
+    }
+
+
+    /**
+        Creates all possible rows in parallel, in ranges of ranks;
+        the function is called concurrently, and returns false to stop the creation of the rest of the rows.
+     */
+    template <class T, class Alloc, class F>
+    bool parallelCreateRows(TaskScheduler &scheduler, const std::vector<T, Alloc> &values, const size_t rowLength, const size_t grainSize, const F &func)
+    {
+        return parallelFor(scheduler, 0, getRowCount(values.size(), rowLength), grainSize, [&](size_t beginRank, size_t endRank)
+        {
+            return createRows(values, rowLength, beginRank, endRank, func);
+        });
+    }
+
+
 } //namespace Lottery
 
 
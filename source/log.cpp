@@ -1,8 +1,15 @@
 #include <fstream>
 #include <iomanip>
 #include <ctime>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "Log.hpp"
+#include "BoundedQueue.hpp"
 
 
 #if defined(_WIN32) || defined(_WIN64)
@@ -14,35 +21,73 @@ namespace Lottery
 {
 
 
-    //file to write to
-    static std::ofstream _logFile;
+    //maximum number of messages waiting to be written
+    static constexpr size_t LogQueueCapacity = 1 << 14;
 
 
-    //logs a message.
-    void log(const char *str)
+    //the minimum level; kept apart from the state, so that checking the level does not start the writer
+    static std::atomic<int> _level{ LOTTERY_LOG_LEVEL };
+
+
+    //a queued message
+    struct LogMessage
     {
-        //open the log file
-        if (!_logFile.is_open())
-        {
-            _logFile.open(toString(getenv("LOTTERYPRIVATE"), "/Logs/log.txt").c_str());
-        }
+        LogLevel level = LogLevel::Info;
+        std::chrono::system_clock::time_point time;
+        std::string text;
+    };
+
+
+    //the state of the logger; it is never destroyed, so that logging works until the very end
+    struct LoggerState
+    {
+        std::atomic<bool> consoleOutput{ true };
+        std::atomic<uint64_t> droppedCount{ 0 };
+        BoundedQueue<LogMessage> queue{ LogQueueCapacity };
+
+        //the writer; it uses the queue while running, and writes directly after stopping
+        std::mutex mutex;
+        std::condition_variable wakeUp;
+        std::condition_variable written;
+        std::thread thread;
+        std::atomic<bool> running{ false };
+        std::atomic<size_t> pushingCount{ 0 };
+        size_t writtenCount = 0;
+        std::ofstream file;
+        std::time_t lastTime = -1;
+        std::string lastTimeString;
+    };
+
 
-        //get current time to write to the log file
-        auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
+    //level names
+    static const char *_levelNames[] = { "Debug: ", "", "Warning: ", "Error: " };
 
-        //create the full logging message
-        std::stringstream stream;
-        stream  << '[' << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "] " << str << '\n';
+
+    //writes a message to the outputs; called either by the writer thread or under the mutex
+    static void _writeMessage(LoggerState &state, const LogMessage &message)
+    {
+        //formatting the time is slow, so it is done once per second
+        const std::time_t t = std::chrono::system_clock::to_time_t(message.time);
+        if (t != state.lastTime)
+        {
+            const std::tm tm = *std::localtime(&t);
+            std::stringstream stream;
+            stream << '[' << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << "] ";
+            state.lastTime = t;
+            state.lastTimeString = stream.str();
+        }
 
         //the message to write
-        const std::string msg = stream.str();
+        const std::string msg = state.lastTimeString + _levelNames[(int)message.level] + message.text + '\n';
 
         //write the log
-        _logFile << msg;
+        state.file << msg;
 
         //write the log into the console
-        std::cout << msg;
+        if (state.consoleOutput)
+        {
+            std::cout << msg;
+        }
 
         //in windows, also print the message in the debug output
         #if defined(_WIN32) || defined(_WIN64)
@@ -51,4 +96,176 @@ namespace Lottery
     }
 
 
+    //the writer thread
+    static void _writerThread(LoggerState &state)
+    {
+        std::unique_lock<std::mutex> lock(state.mutex);
+        for (;;)
+        {
+            //write the queued messages; producers do not take the mutex
+            LogMessage message;
+            bool wrote = false;
+            while (state.queue.tryPop(message))
+            {
+                _writeMessage(state, message);
+                ++state.writtenCount;
+                wrote = true;
+            }
+
+            if (wrote)
+            {
+                state.file.flush();
+                std::cout.flush();
+                state.written.notify_all();
+            }
+
+            if (!state.running)
+            {
+                break;
+            }
+
+            //producers do not notify, so that they never block; the writer polls instead, faster while busy
+            state.wakeUp.wait_for(lock, std::chrono::milliseconds(wrote ? 1 : 20));
+        }
+    }
+
+
+    //stops the writer thread at exit; later messages are written directly
+    static void _stop();
+
+
+    //returns the state, starting the writer thread on first use
+    static LoggerState &_getState()
+    {
+        static LoggerState *state = []()
+        {
+            LoggerState *result = new LoggerState;
+            const char *privateDirectory = std::getenv("LOTTERYPRIVATE");
+            if (privateDirectory)
+            {
+                result->file.open(toString(privateDirectory, "/Logs/log.txt").c_str());
+            }
+            result->running = true;
+            result->thread = std::thread(&_writerThread, std::ref(*result));
+            std::atexit(&_stop);
+            return result;
+        }();
+        return *state;
+    }
+
+
+    //stops the writer thread
+    static void _stop()
+    {
+        LoggerState &state = _getState();
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.running = false;
+        }
+        state.wakeUp.notify_all();
+        state.thread.join();
+
+        //wait for producers which saw the writer running and are still pushing;
+        //later producers see it stopped and write directly
+        while (state.pushingCount.load() > 0)
+        {
+            std::this_thread::yield();
+        }
+
+        //write the messages queued while stopping
+        std::lock_guard<std::mutex> lock(state.mutex);
+        LogMessage message;
+        while (state.queue.tryPop(message))
+        {
+            _writeMessage(state, message);
+        }
+
+        if (state.droppedCount > 0)
+        {
+            LogMessage droppedMessage{ LogLevel::Warning, std::chrono::system_clock::now(), toString(state.droppedCount.load(), " log messages were dropped") };
+            _writeMessage(state, droppedMessage);
+        }
+
+        state.file.flush();
+        std::cout.flush();
+    }
+
+
+    //checks the level
+    bool Logger::isEnabled(LogLevel level)
+    {
+        return (int)level >= _level.load(std::memory_order_relaxed);
+    }
+
+
+    //sets the level
+    void Logger::setLevel(LogLevel level)
+    {
+        _level = (int)level;
+    }
+
+
+    //enables the console
+    void Logger::setConsoleOutput(bool enabled)
+    {
+        _getState().consoleOutput = enabled;
+    }
+
+
+    //queues a message
+    void Logger::write(LogLevel level, std::string &&text)
+    {
+        LoggerState &state = _getState();
+        LogMessage message{ level, std::chrono::system_clock::now(), std::move(text) };
+
+        //the producer is counted before checking the state, so that _stop either waits for the push
+        //to drain it, or the producer sees the writer stopped
+        ++state.pushingCount;
+        if (state.running)
+        {
+            if (!state.queue.tryPush(std::move(message)))
+            {
+                ++state.droppedCount;
+            }
+            --state.pushingCount;
+            return;
+        }
+        --state.pushingCount;
+
+        //after the writer has stopped, write directly
+        std::lock_guard<std::mutex> lock(state.mutex);
+        _writeMessage(state, message);
+        state.file.flush();
+        std::cout.flush();
+    }
+
+
+    //waits for the queued messages
+    void Logger::flush()
+    {
+        LoggerState &state = _getState();
+        const size_t target = state.queue.getPushCount();
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.wakeUp.notify_all();
+        state.written.wait(lock, [&]() { return state.writtenCount >= target || !state.running; });
+    }
+
+
+    //returns the dropped message count
+    uint64_t Logger::getDroppedCount()
+    {
+        return _getState().droppedCount;
+    }
+
+
+    //logs a message.
+    void log(const char *str)
+    {
+        if (Logger::isEnabled(LogLevel::Info))
+        {
+            Logger::write(LogLevel::Info, str);
+        }
+    }
+
+
 } //namespace Lottery
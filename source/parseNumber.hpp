@@ -0,0 +1,46 @@
+#ifndef LOTTERY_PARSENUMBER_HPP
+#define LOTTERY_PARSENUMBER_HPP
+
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+
+namespace Lottery
+{
+
+
+    /**
+        Parses an unsigned decimal integer, i.e. a command line option or a parameter.
+        The whole text must be the number; signs and spaces are not accepted.
+        @param str text to parse.
+        @param name name of the value, for the error message.
+        @param maxValue maximum accepted value.
+        @return the number.
+        @exception std::runtime_error if the text is not a number or the number is greater than the maximum.
+     */
+    inline uint64_t parseNumber(const std::string &str, const std::string &name, uint64_t maxValue = UINT64_MAX)
+    {
+        if (!str.empty() && str.find_first_not_of("0123456789") == std::string::npos)
+        {
+            try
+            {
+                const uint64_t result = std::stoull(str);
+                if (result <= maxValue)
+                {
+                    return result;
+                }
+            }
+            catch (const std::out_of_range &)
+            {
+            }
+        }
+        throw std::runtime_error("invalid " + name + ": " + str);
+    }
+
+
+} //namespace Lottery
+
+
+#endif //LOTTERY_PARSENUMBER_HPP